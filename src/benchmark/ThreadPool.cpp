@@ -0,0 +1,107 @@
+#include <algorithm>
+
+#include "platform.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Pool and queue index of the calling worker thread, if any
+thread_local const ThreadPool* tlPool = nullptr;
+thread_local std::size_t tlIndex = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(
+    std::size_t numThreads,
+    std::function<void(std::size_t)> onStart
+)
+{
+    numThreads = std::max<std::size_t>(1, numThreads);
+
+    // Threads inherit their creator's affinity; widen it again when the pool
+    // is started from a pinned worker, so the pool does not share one CPU
+    if (!onStart) {
+        std::vector<int> cpus = processAffinity();
+        if (!cpus.empty() && cpus != currentThreadAffinity()) {
+            onStart = [cpus = std::move(cpus)](std::size_t) { pinCurrentThread(cpus); };
+        }
+    }
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    _workers.reserve(numThreads);
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        _workers.emplace_back([this, i, onStart] { workerLoop(i, onStart); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _cv.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    // Count the task before queueing it, so a worker never pops an uncounted task
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_pending;
+    }
+    const std::size_t index = (tlPool == this) ? tlIndex : _nextQueue++ % _queues.size();
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    _cv.notify_one();
+}
+
+bool ThreadPool::tryPop(std::size_t index, std::function<void()>& task) {
+    for (std::size_t offset = 0; offset < _queues.size(); ++offset) {
+        Queue& queue = *_queues[(index + offset) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(std::size_t index, const std::function<void(std::size_t)>& onStart) {
+    tlPool = this;
+    tlIndex = index;
+    if (onStart) {
+        onStart(index);
+    }
+    while (true) {
+        std::function<void()> task;
+        if (tryPop(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                --_pending;
+            }
+            task();
+            continue;
+        }
+
+        // A task counted in _pending may not be queued yet, or may have just
+        // been taken by another worker; retrying covers both windows
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _stopping || _pending > 0; });
+        if (_stopping && _pending == 0) {
+            return;
+        }
+    }
+}
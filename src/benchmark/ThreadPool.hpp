@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size work-stealing pool of worker threads.
+//
+// Every worker has its own task queue. Tasks submitted from outside the pool
+// are dealt to the queues round-robin; tasks submitted by a worker go to its
+// own queue. A worker runs its own tasks oldest first, and when its queue is
+// empty steals the newest task of another worker, so uneven task durations do
+// not leave workers idle.
+class ThreadPool {
+public:
+    // Start numThreads workers (at least one). Each worker calls onStart with
+    // its index before taking tasks, e.g. to pin itself to a CPU. Without
+    // onStart, workers may run on every CPU of the process (processAffinity()),
+    // even if the pool is started by a thread pinned to one of them.
+    explicit ThreadPool(
+        std::size_t numThreads,
+        std::function<void(std::size_t)> onStart = {});
+
+    // Finish all queued tasks, then join the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return _workers.size(); }
+
+    // Queue a task; its result or exception is delivered through the future.
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> future = packaged->get_future();
+        push([packaged] { (*packaged)(); });
+        return future;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task);
+    // Pop from the worker's own queue, or steal from another one
+    bool tryPop(std::size_t index, std::function<void()>& task);
+    void workerLoop(std::size_t index, const std::function<void(std::size_t)>& onStart);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<std::size_t> _nextQueue{0};
+
+    // Guards _pending and _stopping; idle workers sleep on _cv
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::size_t _pending{0};
+    bool _stopping{false};
+};
+
+// Run work(t) for every t in [0, threads) on a pool of that many workers and
+// wait for all of them; the caller splits its input into one range per t.
+// Runs inline for a single thread. The first exception is rethrown.
+template <typename F>
+void parallelForRanges(std::size_t threads, F&& work) {
+    if (threads <= 1) {
+        work(std::size_t{0});
+        return;
+    }
+    ThreadPool pool(threads);
+    std::vector<std::future<void>> done;
+    done.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t) {
+        done.push_back(pool.submit([&work, t] { work(t); }));
+    }
+    for (auto& future : done) {
+        future.get();
+    }
+}
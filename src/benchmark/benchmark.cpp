@@ -1,32 +1,246 @@
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
 
 #include "benchmark.hpp"
 
+namespace {
+
+// Fixed, so the same chunks train the dictionary in every run
+constexpr std::uint64_t kDictionarySampleSeed = 0x5eed;
+
+// Largest arena compressed chunks are written to before they are copied out;
+// the memory needed beyond the branch and its compressed chunks is at most
+// this, not a second branch
+constexpr std::size_t kCompressArenaBytes = std::size_t{256} << 20;
+
+// Snapshot of the calling thread's counters; stop() returns the difference.
+class MemoryProbe {
+public:
+    MemoryProbe()
+        : _faults(currentThreadPageFaults()), _pool(BufferPool::threadStats())
+    {
+    }
+
+    MemoryStats stop() const {
+        const PageFaults faults = currentThreadPageFaults();
+        return {
+            .pageFaults = {
+                .minor = faults.minor - _faults.minor,
+                .major = faults.major - _faults.major
+            },
+            .pool = BufferPool::threadStats() - _pool
+        };
+    }
+
+private:
+    PageFaults _faults;
+    BufferPoolStats _pool;
+};
+
+void addMemoryStats(MemoryStats& total, const MemoryStats& part) {
+    total.pageFaults.minor += part.pageFaults.minor;
+    total.pageFaults.major += part.pageFaults.major;
+    total.pool += part.pool;
+}
+
+} // namespace
+
+std::size_t CompressionResult::compressedSizeBytes() const {
+    std::size_t total = overheadBytes + dictionary.size();
+    for (const auto& chunk : compressedChunks) {
+        total += chunk.data.size();
+    }
+    return total;
+}
+
+std::size_t CompressionResult::numFloats() const {
+    std::size_t total = 0;
+    for (const auto& chunk : compressedChunks) {
+        total += chunk.numFloats;
+    }
+    return total;
+}
+
+std::vector<std::vector<float>> splitIntoChunks(
+    const std::vector<float>& data,
+    std::size_t chunkSize
+)
+{
+    const std::size_t floatsPerChunk = std::max<std::size_t>(1, chunkSize / sizeof(float));
+
+    std::vector<std::vector<float>> chunks;
+    chunks.reserve((data.size() + floatsPerChunk - 1) / floatsPerChunk);
+    for (std::size_t start = 0; start < data.size(); start += floatsPerChunk) {
+        const std::size_t end = std::min(start + floatsPerChunk, data.size());
+        chunks.emplace_back(data.begin() + start, data.begin() + end);
+    }
+    return chunks;
+}
+
+std::vector<std::size_t> sampleChunkIndices(
+    std::size_t numChunks,
+    double fraction,
+    std::uint64_t seed
+)
+{
+    if (numChunks == 0) {
+        return {};
+    }
+    const auto numSamples = std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::llround(fraction * numChunks)), 1, numChunks);
+
+    std::mt19937_64 rng(seed);
+    std::vector<std::size_t> indices;
+    indices.reserve(numSamples);
+    for (std::size_t s = 0; s < numSamples; ++s) {
+        const std::size_t first = s * numChunks / numSamples;
+        const std::size_t last = (s + 1) * numChunks / numSamples;
+        std::uniform_int_distribution<std::size_t> pick(first, last - 1);
+        indices.push_back(pick(rng));
+    }
+    return indices;
+}
+
 CompressionResult timedCompress(
     Compressor& compressor,
-    const std::vector<float>& data
+    const std::vector<std::vector<float>>& chunks
 ) 
 {
+    // Train the shared dictionary; zstd's trainer works best on about 100 times
+    // the dictionary size
+    std::vector<std::uint8_t> dictionary;
+    std::chrono::duration<double, std::milli> dictionaryElapsed{0};
+    if (const std::size_t capacity = compressor.dictionaryCapacity(); capacity > 0 && !chunks.empty()) {
+        std::size_t totalBytes = 0;
+        for (const auto& chunk : chunks) {
+            totalBytes += chunk.size() * sizeof(float);
+        }
+        const double fraction = std::min(1.0, 100.0 * capacity / std::max<std::size_t>(1, totalBytes));
+        std::vector<std::vector<float>> samples;
+        for (std::size_t index : sampleChunkIndices(chunks.size(), fraction, kDictionarySampleSeed)) {
+            samples.push_back(chunks[index]);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        dictionary = compressor.trainDictionary(samples);
+        dictionaryElapsed = std::chrono::high_resolution_clock::now() - start;
+    }
+
+    std::vector<CompressedData> compressedChunks(chunks.size());
+    std::chrono::duration<double, std::milli> elapsed{0};
+    MemoryStats memory;
+    std::vector<std::size_t> bounds(chunks.size());
+    std::size_t totalBound = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        bounds[i] = compressor.maxCompressedSize(chunks[i].size());
+        totalBound += bounds[i];
+    }
+
+    if (std::find(bounds.begin(), bounds.end(), 0) != bounds.end()) {
+        // Compressors that cannot bound their output allocate it while timed
+        const MemoryProbe probe;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            compressedChunks[i] = compressor.compress(chunks[i]);
+        }
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+        memory = probe.stop();
+    } else if (!chunks.empty()) {
+        // Batches of chunks are compressed into slices of one pooled arena,
+        // faulted in when first mapped and reused across calls; only the
+        // compression is timed, and each batch is copied out to exact-size
+        // buffers between timed regions
+        const std::size_t maxBound = *std::max_element(bounds.begin(), bounds.end());
+        PooledBuffer arena = BufferPool::global().acquire(
+            std::min(totalBound, std::max(kCompressArenaBytes, maxBound)));
+        std::vector<std::span<std::uint8_t>> outputs;
+        std::vector<std::size_t> sizes(chunks.size());
+        for (std::size_t first = 0; first < chunks.size();) {
+            std::size_t last = first;
+            std::size_t used = 0;
+            outputs.clear();
+            while (last < chunks.size() && used + bounds[last] <= arena.size()) {
+                outputs.push_back(arena.bytes().subspan(used, bounds[last]));
+                used += bounds[last];
+                ++last;
+            }
+
+            const MemoryProbe probe;
+            auto start = std::chrono::high_resolution_clock::now();
+            compressor.compressChunksInto(
+                std::span(chunks).subspan(first, last - first),
+                outputs,
+                std::span(sizes).subspan(first, last - first));
+            elapsed += std::chrono::high_resolution_clock::now() - start;
+            addMemoryStats(memory, probe.stop());
+
+            for (std::size_t i = first; i < last; ++i) {
+                const std::span<std::uint8_t> output = outputs[i - first].first(sizes[i]);
+                compressedChunks[i] = {
+                    .data = std::vector<std::uint8_t>(output.begin(), output.end()),
+                    .numFloats = chunks[i].size()
+                };
+            }
+            first = last;
+        }
+    }
+
+    return {
+        .compressedChunks = std::move(compressedChunks),
+        .elapsed = elapsed,
+        .dictionary = std::move(dictionary),
+        .dictionaryElapsed = dictionaryElapsed,
+        .memory = memory
+    };
+}
+
+DecompressionResult timedDecompress(
+    Compressor& compressor,
+    const std::vector<CompressedData>& compressedChunks
+) 
+{
+    std::size_t totalFloats = 0;
+    for (const auto& chunk : compressedChunks) {
+        totalFloats += chunk.numFloats;
+    }
+    // Zero-initialization faults the output in before timing
+    std::vector<float> decompressedData(totalFloats);
+
+    const MemoryProbe probe;
     auto start = std::chrono::high_resolution_clock::now();
-    CompressedData compressedData = compressor.compress(data);
+    compressor.decompressChunksInto(compressedChunks, decompressedData);
     auto end = std::chrono::high_resolution_clock::now();
     return {
-        .compressedData = std::move(compressedData),
-        .elapsed = end - start
+        .decompressedData = std::move(decompressedData),
+        .elapsed = end - start,
+        .memory = probe.stop()
     };
 }
 
 DecompressionResult timedDecompress(
     Compressor& compressor,
-    const CompressedData& compressedData
-) 
+    const ContainerReader& container
+)
 {
+    // Zero-initialization faults the output in before timing
+    std::vector<float> decompressedData(container.info().numFloats);
+
+    const MemoryProbe probe;
     auto start = std::chrono::high_resolution_clock::now();
-    std::vector<float> decompressedData = compressor.decompress(compressedData);
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < container.numChunks(); ++i) {
+        const ContainerChunk chunk = container.chunk(i);
+        compressor.decompressInto(chunk.bytes, std::span(decompressedData).subspan(offset, chunk.numFloats));
+        offset += chunk.numFloats;
+    }
     auto end = std::chrono::high_resolution_clock::now();
     return {
         .decompressedData = std::move(decompressedData),
-        .elapsed = end - start
+        .elapsed = end - start,
+        .memory = probe.stop()
     };
 }
 
@@ -42,7 +256,7 @@ BenchmarkResult computeBenchmarkMetrics(
     }
 
     size_t dataSizeBytes = original.size() * sizeof(float);
-    float compressionRatio = static_cast<float>(dataSizeBytes) / compResult.compressedData.data.size();
+    float compressionRatio = static_cast<float>(dataSizeBytes) / compResult.compressedSizeBytes();
     float compressionThroughputMbps = (dataSizeBytes / (1024.0f * 1024.0f)) / (compResult.elapsed.count() / 1000.0f);
     float decompressionThroughputMbps = (dataSizeBytes / (1024.0f * 1024.0f)) / (decompResult.elapsed.count() / 1000.0f);
 
@@ -70,6 +284,8 @@ BenchmarkResult computeBenchmarkMetrics(
     float PSNR = (MSE > 0.0f) ? 10.0f * std::log10((1.0f * 1.0f) / MSE) : std::numeric_limits<float>::infinity();
 
     return {
+        .originalSizeBytes = dataSizeBytes,
+        .compressedSizeBytes = compResult.compressedSizeBytes(),
         .compressionRatio = compressionRatio,
         .compressionThroughputMbps = compressionThroughputMbps,
         .decompressionThroughputMbps = decompressionThroughputMbps,
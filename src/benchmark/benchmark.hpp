@@ -1,23 +1,53 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <vector>
 
+#include "BufferPool.hpp"
 #include "Compressor.hpp"
+#include "container.hpp"
+#include "platform.hpp"
+
+// Memory activity inside a timed region, on the thread that ran it.
+struct MemoryStats {
+    PageFaults pageFaults;
+    // Scratch buffers taken from BufferPool::global(); mapping and prefaulting
+    // new ones (pool.mapElapsed) is included in the elapsed time
+    BufferPoolStats pool;
+};
 
 // Result of a timed compression run.
+// Data is compressed in independent chunks; elapsed covers all of them.
 struct CompressionResult {
-    CompressedData compressedData;
+    std::vector<CompressedData> compressedChunks;
     std::chrono::duration<double, std::milli> elapsed;
+    // Side information stored with the chunks (e.g. a layout's validity mask)
+    std::size_t overheadBytes{0};
+    // Dictionary shared by all chunks, stored once; empty if none was trained
+    std::vector<std::uint8_t> dictionary;
+    // Time spent training the dictionary, not included in elapsed
+    std::chrono::duration<double, std::milli> dictionaryElapsed{0};
+    MemoryStats memory;
+
+    // Total size of all compressed chunks plus overhead and dictionary, in bytes.
+    std::size_t compressedSizeBytes() const;
+
+    // Total number of floats represented by all compressed chunks.
+    std::size_t numFloats() const;
 };
 
 // Result of a timed decompression run.
 struct DecompressionResult {
     std::vector<float> decompressedData;
     std::chrono::duration<double, std::milli> elapsed;
+    MemoryStats memory;
 };
 
 struct BenchmarkResult {
+    std::size_t originalSizeBytes;
+    std::size_t compressedSizeBytes;
+
     float compressionRatio;
     float compressionThroughputMbps;
     float decompressionThroughputMbps;
@@ -31,18 +61,47 @@ struct BenchmarkResult {
     float PSNR;
 };
 
-// Run compression while measuring wall-clock time.
+// Split data into consecutive chunks of at most chunkSize bytes.
+// chunkSize is rounded down to a whole number of floats (minimum one).
+std::vector<std::vector<float>> splitIntoChunks(
+    const std::vector<float>& data,
+    std::size_t chunkSize);
+
+// Choose a stratified random sample of chunk indices: the chunks are divided
+// into equal strata and one chunk is drawn from each. Returns at least one
+// index (for non-empty input), in ascending order.
+std::vector<std::size_t> sampleChunkIndices(
+    std::size_t numChunks,
+    double fraction,
+    std::uint64_t seed);
+
+// Run compression over every chunk while measuring wall-clock time. If the
+// compressor uses a dictionary (Compressor::dictionaryCapacity), it is first
+// trained on a stratified sample of the chunks (see sampleChunkIndices) of
+// about 100 times its capacity, and the training is timed separately.
+// Compressors that bound their output (Compressor::maxCompressedSize) write
+// to a pooled arena of at most 256 MB, in batches timed separately, so that
+// allocating and copying out the compressed chunks are not timed.
 CompressionResult timedCompress(
     Compressor& compressor,
-    const std::vector<float>& data);
+    const std::vector<std::vector<float>>& chunks);
+
+// Run decompression over every chunk while measuring wall-clock time.
+// Chunks are decompressed in place into a single vector in their original
+// order; the vector is allocated and faulted in before timing starts.
+DecompressionResult timedDecompress(
+    Compressor& compressor,
+    const std::vector<CompressedData>& compressedChunks);
 
-// Run decompression while measuring wall-clock time.
+// Run decompression over every chunk of a memory-mapped container while
+// measuring wall-clock time. Chunks are read in place; page faults on the
+// mapping are included in the elapsed time, those on the output are not.
 DecompressionResult timedDecompress(
     Compressor& compressor,
-    const CompressedData& compressedData);
+    const ContainerReader& container);
 
 // Compute benchmark metrics given original and decompressed data.
 BenchmarkResult computeBenchmarkMetrics(
     const std::vector<float>& original,
     const CompressionResult& compResult,
-    const DecompressionResult& decompResult);
\ No newline at end of file
+    const DecompressionResult& decompResult);
@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "characterize.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Values per block; the scalar histogram pass rereads a block from L1
+constexpr std::size_t kBlock = 4096;
+
+// Hashes kept by the distinct-value sketch
+constexpr std::size_t kSketchSize = 1024;
+
+constexpr std::uint32_t kExponentMask = 0x7f800000u;
+constexpr std::uint32_t kMantissaMask = 0x007fffffu;
+constexpr int kMantissaBits = 23;
+
+// The murmur3 finalizer; a bijection on 32 bits, so distinct values never collide
+std::uint32_t mix32(std::uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// k-minimum-values sketch of 32-bit hashes. Once full, only hashes below the
+// largest kept one can enter, so most values are rejected by one comparison.
+class DistinctSketch {
+public:
+    void insert(std::uint32_t hash) {
+        if (hash >= _threshold) {
+            return;
+        }
+        _hashes.insert(hash);
+        if (_hashes.size() > kSketchSize) {
+            _hashes.erase(std::prev(_hashes.end()));
+        }
+        if (_hashes.size() == kSketchSize) {
+            _threshold = *_hashes.rbegin();
+        }
+    }
+
+    void merge(const DistinctSketch& other) {
+        for (std::uint32_t hash : other._hashes) {
+            insert(hash);
+        }
+    }
+
+    std::uint32_t threshold() const { return _threshold; }
+
+    // Exact while the sketch is not full
+    double estimate() const {
+        if (_hashes.size() < kSketchSize) {
+            return static_cast<double>(_hashes.size());
+        }
+        const double largest = (static_cast<double>(*_hashes.rbegin()) + 1.0) / 4294967296.0;
+        return (kSketchSize - 1) / largest;
+    }
+
+private:
+    std::set<std::uint32_t> _hashes;
+    std::uint32_t _threshold{std::numeric_limits<std::uint32_t>::max()};
+};
+
+struct PartialStats {
+    std::size_t nonFinite{0};
+    std::size_t zeros{0};
+    float min{std::numeric_limits<float>::infinity()};
+    float max{-std::numeric_limits<float>::infinity()};
+    double sum{0.0};
+    std::uint32_t mantissaOr{0};
+    std::uint64_t trailingZeroSum{0};
+    std::array<std::array<std::uint64_t, 256>, 4> bytePlanes{};
+    std::array<std::uint64_t, 256> exponents{};
+    DistinctSketch sketch;
+};
+
+std::uint32_t bitsOf(float value) {
+    return std::bit_cast<std::uint32_t>(value);
+}
+
+bool isFiniteBits(std::uint32_t bits) {
+    return (bits & kExponentMask) != kExponentMask;
+}
+
+// Range, sum, counts and mantissa OR of a block
+void scanScalar(const float* values, std::size_t count, PartialStats& s) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint32_t bits = bitsOf(values[i]);
+        if (!isFiniteBits(bits)) {
+            ++s.nonFinite;
+            continue;
+        }
+        s.zeros += values[i] == 0.0f;
+        s.min = std::min(s.min, values[i]);
+        s.max = std::max(s.max, values[i]);
+        s.sum += values[i];
+        s.mantissaOr |= bits & kMantissaMask;
+    }
+}
+
+void sketchScalar(const float* values, std::size_t count, DistinctSketch& sketch) {
+    for (std::size_t i = 0; i < count; ++i) {
+        sketch.insert(mix32(bitsOf(values[i])));
+    }
+}
+
+// Centered sums for the lag-1 autocorrelation over values [0, count), with
+// pairs (i, i + 1) for i < pairs; pairs with a non-finite value are skipped
+void lagScalar(const float* values, std::size_t count, std::size_t pairs, double mean, double& sxx, double& sxy) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!std::isfinite(values[i])) {
+            continue;
+        }
+        const double d = values[i] - mean;
+        sxx += d * d;
+        if (i < pairs && std::isfinite(values[i + 1])) {
+            sxy += d * (values[i + 1] - mean);
+        }
+    }
+}
+
+#if defined(__x86_64__)
+
+bool cpuHasAvx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+__attribute__((target("avx2")))
+void scanAvx2(const float* values, std::size_t count, PartialStats& s) {
+    const __m256i exponentMask = _mm256_set1_epi32(static_cast<int>(kExponentMask));
+    const __m256i mantissaMask = _mm256_set1_epi32(static_cast<int>(kMantissaMask));
+    const __m256 posInf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 negInf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256 vmin = posInf;
+    __m256 vmax = negInf;
+    __m256d sumLo = _mm256_setzero_pd();
+    __m256d sumHi = _mm256_setzero_pd();
+    __m256i mantissaOr = _mm256_setzero_si256();
+    // Lanes count down by one per match; a block is far below 2^31 values
+    __m256i nonFinite = _mm256_setzero_si256();
+    __m256i zeros = _mm256_setzero_si256();
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(values + i);
+        const __m256i bits = _mm256_castps_si256(v);
+        const __m256i isNonFinite = _mm256_cmpeq_epi32(_mm256_and_si256(bits, exponentMask), exponentMask);
+        const __m256 nonFiniteMask = _mm256_castsi256_ps(isNonFinite);
+
+        vmin = _mm256_min_ps(vmin, _mm256_blendv_ps(v, posInf, nonFiniteMask));
+        vmax = _mm256_max_ps(vmax, _mm256_blendv_ps(v, negInf, nonFiniteMask));
+        const __m256 finite = _mm256_andnot_ps(nonFiniteMask, v);
+        sumLo = _mm256_add_pd(sumLo, _mm256_cvtps_pd(_mm256_castps256_ps128(finite)));
+        sumHi = _mm256_add_pd(sumHi, _mm256_cvtps_pd(_mm256_extractf128_ps(finite, 1)));
+        mantissaOr = _mm256_or_si256(mantissaOr, _mm256_andnot_si256(isNonFinite, _mm256_and_si256(bits, mantissaMask)));
+        nonFinite = _mm256_add_epi32(nonFinite, isNonFinite);
+        zeros = _mm256_add_epi32(zeros, _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_EQ_OQ)));
+    }
+
+    alignas(32) float mins[8];
+    alignas(32) float maxs[8];
+    alignas(32) double sums[4];
+    alignas(32) std::uint32_t ors[8];
+    alignas(32) std::int32_t nonFiniteCounts[8];
+    alignas(32) std::int32_t zeroCounts[8];
+    _mm256_store_ps(mins, vmin);
+    _mm256_store_ps(maxs, vmax);
+    _mm256_store_pd(sums, _mm256_add_pd(sumLo, sumHi));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(ors), mantissaOr);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(nonFiniteCounts), nonFinite);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(zeroCounts), zeros);
+    for (int lane = 0; lane < 8; ++lane) {
+        s.min = std::min(s.min, mins[lane]);
+        s.max = std::max(s.max, maxs[lane]);
+        s.mantissaOr |= ors[lane];
+        s.nonFinite += static_cast<std::size_t>(-nonFiniteCounts[lane]);
+        s.zeros += static_cast<std::size_t>(-zeroCounts[lane]);
+    }
+    s.sum += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+
+    scanScalar(values + i, count - i, s);
+}
+
+__attribute__((target("avx2")))
+__m256i mix32Avx2(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x85ebca6bu)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0xc2b2ae35u)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+// Hash eight values at a time and only insert those below the sketch threshold
+__attribute__((target("avx2")))
+void sketchAvx2(const float* values, std::size_t count, DistinctSketch& sketch) {
+    // AVX2 has no unsigned compare; flipping the sign bit maps it to a signed one
+    const __m256i signBit = _mm256_set1_epi32(std::numeric_limits<std::int32_t>::min());
+    __m256i threshold = _mm256_set1_epi32(static_cast<int>(sketch.threshold() ^ 0x80000000u));
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i hashes = mix32Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        const __m256i below = _mm256_cmpgt_epi32(threshold, _mm256_xor_si256(hashes, signBit));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(below));
+        if (mask == 0) {
+            continue;
+        }
+        alignas(32) std::uint32_t candidates[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(candidates), hashes);
+        while (mask) {
+            sketch.insert(candidates[std::countr_zero(static_cast<unsigned>(mask))]);
+            mask &= mask - 1;
+        }
+        threshold = _mm256_set1_epi32(static_cast<int>(sketch.threshold() ^ 0x80000000u));
+    }
+
+    sketchScalar(values + i, count - i, sketch);
+}
+
+// lagScalar for blocks without non-finite values
+__attribute__((target("avx2")))
+void lagAvx2(const float* values, std::size_t count, std::size_t pairs, double mean, double& sxx, double& sxy) {
+    const __m256d m = _mm256_set1_pd(mean);
+    __m256d xx = _mm256_setzero_pd();
+    __m256d xy = _mm256_setzero_pd();
+
+    std::size_t i = 0;
+    for (; i + 4 <= pairs; i += 4) {
+        const __m256d d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(values + i)), m);
+        const __m256d d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(values + i + 1)), m);
+        xx = _mm256_add_pd(xx, _mm256_mul_pd(d0, d0));
+        xy = _mm256_add_pd(xy, _mm256_mul_pd(d0, d1));
+    }
+
+    alignas(32) double xxs[4];
+    alignas(32) double xys[4];
+    _mm256_store_pd(xxs, xx);
+    _mm256_store_pd(xys, xy);
+    sxx += (xxs[0] + xxs[1]) + (xxs[2] + xxs[3]);
+    sxy += (xys[0] + xys[1]) + (xys[2] + xys[3]);
+
+    lagScalar(values + i, count - i, pairs - i, mean, sxx, sxy);
+}
+
+#else
+
+bool cpuHasAvx2() {
+    return false;
+}
+
+#endif
+
+void scan(const float* values, std::size_t count, PartialStats& s, bool avx2) {
+#if defined(__x86_64__)
+    if (avx2) {
+        scanAvx2(values, count, s);
+        sketchAvx2(values, count, s.sketch);
+        return;
+    }
+#endif
+    (void)avx2;
+    scanScalar(values, count, s);
+    sketchScalar(values, count, s.sketch);
+}
+
+void lag(const float* values, std::size_t count, std::size_t pairs, double mean, double& sxx, double& sxy,
+         bool avx2, bool allFinite)
+{
+#if defined(__x86_64__)
+    if (avx2 && allFinite) {
+        lagAvx2(values, count, pairs, mean, sxx, sxy);
+        return;
+    }
+#endif
+    (void)avx2;
+    (void)allFinite;
+    lagScalar(values, count, pairs, mean, sxx, sxy);
+}
+
+// Byte planes, exponents and trailing zeros; histogram updates don't vectorize
+void histogramScalar(const float* values, std::size_t count, PartialStats& s) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint32_t bits = bitsOf(values[i]);
+        ++s.bytePlanes[0][bits & 0xff];
+        ++s.bytePlanes[1][(bits >> 8) & 0xff];
+        ++s.bytePlanes[2][(bits >> 16) & 0xff];
+        ++s.bytePlanes[3][bits >> 24];
+        const std::uint32_t exponent = (bits & kExponentMask) >> kMantissaBits;
+        ++s.exponents[exponent];
+        if (exponent != 0xff) {
+            s.trailingZeroSum += std::countr_zero((bits & kMantissaMask) | (1u << kMantissaBits));
+        }
+    }
+}
+
+double entropyBits(const std::array<std::uint64_t, 256>& counts, std::size_t total) {
+    double entropy = 0.0;
+    for (std::uint64_t count : counts) {
+        if (count > 0) {
+            const double p = static_cast<double>(count) / total;
+            entropy -= p * std::log2(p);
+        }
+    }
+    return entropy;
+}
+
+} // namespace
+
+DataCharacteristics characterizeData(
+    const std::vector<float>& values,
+    std::size_t threads
+)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const bool avx2 = cpuHasAvx2();
+    const std::size_t n = values.size();
+    threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(1, n / kBlock));
+
+    // Pass 1: moments, sketch and histograms, block by block
+    std::vector<PartialStats> partial(threads);
+    parallelForRanges(threads, [&](std::size_t t) {
+        const std::size_t first = t * n / threads;
+        const std::size_t last = (t + 1) * n / threads;
+        for (std::size_t block = first; block < last; block += kBlock) {
+            const std::size_t count = std::min(kBlock, last - block);
+            scan(values.data() + block, count, partial[t], avx2);
+            histogramScalar(values.data() + block, count, partial[t]);
+        }
+    });
+
+    PartialStats merged = std::move(partial.front());
+    for (std::size_t t = 1; t < threads; ++t) {
+        const PartialStats& s = partial[t];
+        merged.nonFinite += s.nonFinite;
+        merged.zeros += s.zeros;
+        merged.min = std::min(merged.min, s.min);
+        merged.max = std::max(merged.max, s.max);
+        merged.sum += s.sum;
+        merged.mantissaOr |= s.mantissaOr;
+        merged.trailingZeroSum += s.trailingZeroSum;
+        for (std::size_t plane = 0; plane < 4; ++plane) {
+            for (std::size_t b = 0; b < 256; ++b) {
+                merged.bytePlanes[plane][b] += s.bytePlanes[plane][b];
+            }
+        }
+        for (std::size_t b = 0; b < 256; ++b) {
+            merged.exponents[b] += s.exponents[b];
+        }
+        merged.sketch.merge(s.sketch);
+    }
+
+    DataCharacteristics result;
+    result.numValues = n;
+    result.nonFiniteValues = merged.nonFinite;
+    result.zeroValues = merged.zeros;
+    const std::size_t finite = n - merged.nonFinite;
+    if (finite > 0) {
+        result.min = merged.min;
+        result.max = merged.max;
+        result.mean = merged.sum / finite;
+        result.commonTrailingZeroBits = merged.mantissaOr == 0
+            ? kMantissaBits : std::countr_zero(merged.mantissaOr);
+        result.meanTrailingZeroBits = static_cast<double>(merged.trailingZeroSum) / finite;
+    }
+    result.sketchSize = kSketchSize;
+    result.distinctEstimate = static_cast<std::size_t>(std::llround(
+        std::min(merged.sketch.estimate(), static_cast<double>(n))));
+    result.distinctFraction = n > 0 ? static_cast<double>(result.distinctEstimate) / n : 0.0;
+    for (std::size_t plane = 0; plane < 4; ++plane) {
+        result.bytePlaneEntropy[plane] = n > 0 ? entropyBits(merged.bytePlanes[plane], n) : 0.0;
+    }
+    result.exponentHistogram = merged.exponents;
+
+    // Pass 2: centered sums for the variance and lag-1 correlation; each
+    // range also pairs its last value with the first of the next range
+    std::vector<std::pair<double, double>> sums(threads, {0.0, 0.0});
+    const bool allFinite = merged.nonFinite == 0;
+    parallelForRanges(threads, [&](std::size_t t) {
+        const std::size_t first = t * n / threads;
+        const std::size_t last = (t + 1) * n / threads;
+        for (std::size_t block = first; block < last; block += kBlock) {
+            const std::size_t count = std::min(kBlock, last - block);
+            const std::size_t pairs = block + count < n ? count : count - 1;
+            lag(values.data() + block, count, pairs, result.mean, sums[t].first, sums[t].second, avx2, allFinite);
+        }
+    });
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for (const auto& [xx, xy] : sums) {
+        sxx += xx;
+        sxy += xy;
+    }
+    result.stddev = finite > 0 ? std::sqrt(sxx / finite) : 0.0;
+    result.lag1Correlation = sxx > 0.0 ? sxy / sxx : 1.0;
+
+    result.avx2 = avx2;
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+std::vector<CompressorRecommendation> recommendCompressors(const DataCharacteristics& c) {
+    std::vector<CompressorRecommendation> recommendations;
+    const std::size_t finite = c.numValues - c.nonFiniteValues;
+    if (finite == 0) {
+        return recommendations;
+    }
+
+    // Binades spanned by the central 99% of the finite non-zero values
+    // (exponents 1..254), so a few values near a zero crossing don't count
+    std::uint64_t normal = 0;
+    for (int e = 1; e < 255; ++e) {
+        normal += c.exponentHistogram[e];
+    }
+    const double tail = 0.005 * normal;
+    int lowestExponent = 1;
+    for (double below = 0.0; lowestExponent < 254 && below + c.exponentHistogram[lowestExponent] <= tail; ++lowestExponent) {
+        below += c.exponentHistogram[lowestExponent];
+    }
+    int highestExponent = 254;
+    for (double above = 0.0; highestExponent > 1 && above + c.exponentHistogram[highestExponent] <= tail; --highestExponent) {
+        above += c.exponentHistogram[highestExponent];
+    }
+    const int binades = normal > 0 && highestExponent >= lowestExponent ? highestExponent - lowestExponent + 1 : 0;
+    const double range = static_cast<double>(c.max) - c.min;
+
+    // Quantized or low-cardinality data compresses well without loss
+    const bool lossless = c.distinctFraction < 0.05 || c.commonTrailingZeroBits >= 8;
+    if (lossless) {
+        const std::string reason = std::format(
+            "{:.2f}% distinct values and {} mantissa bits always zero; lossless codecs exploit repeated "
+            "and truncated values", 100.0 * c.distinctFraction, c.commonTrailingZeroBits);
+        recommendations.push_back({"zstd:compressionLevel=9", reason});
+        recommendations.push_back({"blosc2:codec=zstd,compressionLevel=9,filters=shuffle", reason});
+    }
+
+    // Smooth data: neighbours predict each other
+    const bool smooth = c.lag1Correlation > 0.9 && range > 0.0;
+    if (smooth) {
+        const double bound = 1e-4 * range;
+        const std::string reason = std::format(
+            "lag-1 correlation {:.3f}: neighbouring values predict each other; bound is 1e-4 of the value range",
+            c.lag1Correlation);
+        recommendations.push_back({std::format("sz3:errorBoundMode=0,absErrorBound={:.3g}", bound), reason});
+        recommendations.push_back({std::format("zfp:mode=accuracy,tolerance={:.3g}", bound), reason});
+    }
+
+    // Wide dynamic range or noisy low mantissa: bound each value's relative error
+    const bool wide = binades > 12;
+    const bool noisy = !lossless && c.bytePlaneEntropy[0] > 7.5;
+    if (wide || noisy) {
+        const std::string reason = wide
+            ? std::format("values span {} binades; mantissa truncation bounds each value's relative error "
+                          "(below 2^-10 with 10 mantissa bits)", binades)
+            : std::format("low mantissa byte entropy {:.2f} bits: it is noise to a lossless codec; "
+                          "truncation bounds each value's relative error (below 2^-10 with 10 mantissa bits)",
+                          c.bytePlaneEntropy[0]);
+        recommendations.push_back({"blosc2:codec=zstd,filters=trunc_prec+shuffle,truncPrecision=10", reason});
+    }
+
+    // Otherwise quantize with an absolute bound on the scale of the spread
+    if (!lossless && !smooth && !wide && c.stddev > 0.0) {
+        const double bound = 1e-3 * c.stddev;
+        recommendations.push_back({
+            std::format("sz3:errorBoundMode=0,absErrorBound={:.3g}", bound),
+            std::format("lag-1 correlation {:.3f} and {} binades: little structure to predict; "
+                        "bound is 1e-3 of the standard deviation", c.lag1Correlation, binades)
+        });
+    }
+    return recommendations;
+}
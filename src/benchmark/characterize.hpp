@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Properties of a branch's values that predict how well it compresses.
+// Range, mean and standard deviation are over the finite values.
+struct DataCharacteristics {
+    std::size_t numValues{0};
+    std::size_t nonFiniteValues{0};
+    std::size_t zeroValues{0};
+    float min{0.0f};
+    float max{0.0f};
+    double mean{0.0};
+    double stddev{0.0};
+
+    // Distinct bit patterns, estimated with a k-minimum-values sketch of
+    // sketchSize hashes (exact below that many); relative error ~1/sqrt(k)
+    std::size_t distinctEstimate{0};
+    double distinctFraction{0.0};
+    std::size_t sketchSize{0};
+
+    // Shannon entropy in bits per byte of each byte plane of the little-endian
+    // values; plane 0 is the lowest mantissa byte, plane 3 holds the sign and
+    // the high exponent bits
+    std::array<double, 4> bytePlaneEntropy{};
+
+    // Counts per biased IEEE exponent: 0 holds zeros and subnormals, 255
+    // infinities and NaN
+    std::array<std::uint64_t, 256> exponentHistogram{};
+
+    // Low mantissa bits that are zero in every finite value, and on average
+    int commonTrailingZeroBits{0};
+    double meanTrailingZeroBits{0.0};
+
+    // Lag-1 autocorrelation of the finite values in storage order; 1 for
+    // constant data
+    double lag1Correlation{0.0};
+
+    // Whether the AVX2 kernels were used
+    bool avx2{false};
+    std::chrono::duration<double, std::milli> elapsed{0};
+};
+
+// A configuration worth including in a sweep, as a --compressor string.
+struct CompressorRecommendation {
+    std::string compressor;
+    std::string reason;
+};
+
+// Characterize values in one pass for the moments, sketch and histograms and a
+// second for the lag-1 correlation. Contiguous ranges are processed by up to
+// threads threads; range, moments, distinct-value filtering and correlation
+// use AVX2 when the CPU supports it, with a scalar fallback. The fallback sums
+// in a different order, so moments and correlation agree up to rounding.
+DataCharacteristics characterizeData(
+    const std::vector<float>& values,
+    std::size_t threads = 1);
+
+// Suggest compressors and error bounds for a branch from its characteristics.
+// The rules are heuristics that narrow a sweep, not replace it:
+//   - few distinct values or always-zero low mantissa bits: lossless codecs
+//   - strongly correlated neighbours: prediction-based lossy compressors,
+//     with an absolute bound relative to the value range
+//   - the central 99% of values spanning more than 12 binades, or a noisy
+//     low mantissa byte: mantissa truncation, which bounds each value's
+//     relative error
+//   - otherwise: quantization with an absolute bound relative to stddev
+std::vector<CompressorRecommendation> recommendCompressors(const DataCharacteristics& characteristics);
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "estimate.hpp"
+
+namespace {
+
+// Two-sided 95% normal quantile
+constexpr double kZ95 = 1.959963984540054;
+
+// Measurements of one sampled chunk.
+struct ChunkSample {
+    double numFloats;
+    double originalBytes;
+    double compressedBytes;
+    double compressSeconds;
+    double decompressSeconds;
+    double absErrorSum;
+    double relErrorSum;
+    double squaredErrorSum;
+    float absErrorMax;
+    float relErrorMax;
+};
+
+// Ratio estimate sum(y) / sum(x) over the sample with its confidence interval.
+template <typename Y, typename X>
+std::pair<double, Interval> ratioEstimate(
+    const std::vector<ChunkSample>& samples,
+    double samplingFraction,
+    Y y,
+    X x
+)
+{
+    double sumY = 0.0;
+    double sumX = 0.0;
+    for (const auto& s : samples) {
+        sumY += y(s);
+        sumX += x(s);
+    }
+    const double ratio = sumY / sumX;
+
+    // A census has no sampling error; otherwise the variance needs two samples
+    const std::size_t n = samples.size();
+    if (samplingFraction >= 1.0) {
+        return {ratio, {ratio, ratio}};
+    }
+    if (n < 2) {
+        constexpr double kUnknown = std::numeric_limits<double>::quiet_NaN();
+        return {ratio, {kUnknown, kUnknown}};
+    }
+
+    // Delta method: Var(R) ~ (1 - f) * s_e^2 / (n * mean(x)^2), with e_i = y_i - R x_i
+    double residualSq = 0.0;
+    for (const auto& s : samples) {
+        const double e = y(s) - ratio * x(s);
+        residualSq += e * e;
+    }
+    const double meanX = sumX / n;
+    const double variance = (1.0 - samplingFraction) * (residualSq / (n - 1)) / (n * meanX * meanX);
+    const double halfWidth = kZ95 * std::sqrt(std::max(variance, 0.0));
+    return {ratio, {ratio - halfWidth, ratio + halfWidth}};
+}
+
+float psnrFromMSE(double mse) {
+    if (std::isnan(mse)) {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+    return (mse > 0.0) ? 10.0f * std::log10(1.0f / static_cast<float>(mse))
+                       : std::numeric_limits<float>::infinity();
+}
+
+} // namespace
+
+EstimateResult estimateBenchmarkMetrics(
+    Compressor& compressor,
+    const std::vector<float>& data,
+    std::size_t chunkSize,
+    double sampleFraction,
+    std::uint64_t seed
+)
+{
+    const std::size_t floatsPerChunk = std::max<std::size_t>(1, chunkSize / sizeof(float));
+    const std::size_t numChunks = (data.size() + floatsPerChunk - 1) / floatsPerChunk;
+    if (numChunks == 0) {
+        throw std::runtime_error("Cannot estimate metrics for an empty branch.");
+    }
+
+    std::vector<std::vector<float>> sampledChunks;
+    for (std::size_t index : sampleChunkIndices(numChunks, sampleFraction, seed)) {
+        const std::size_t first = index * floatsPerChunk;
+        const std::size_t last = std::min(first + floatsPerChunk, data.size());
+        sampledChunks.emplace_back(data.begin() + first, data.begin() + last);
+    }
+
+    // A shared dictionary is trained on the sample itself
+    const std::size_t dictionaryBytes = compressor.dictionaryCapacity() > 0
+        ? compressor.trainDictionary(sampledChunks).size()
+        : 0;
+
+    std::vector<ChunkSample> samples;
+    for (const auto& chunk : sampledChunks) {
+        auto start = std::chrono::high_resolution_clock::now();
+        CompressedData compressed = compressor.compress(chunk);
+        auto middle = std::chrono::high_resolution_clock::now();
+        std::vector<float> decompressed = compressor.decompress(compressed);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if (decompressed.size() != chunk.size()) {
+            throw std::runtime_error("Original and decompressed data size mismatch.");
+        }
+
+        ChunkSample sample{
+            .numFloats = static_cast<double>(chunk.size()),
+            .originalBytes = static_cast<double>(chunk.size() * sizeof(float)),
+            .compressedBytes = static_cast<double>(compressed.data.size()),
+            .compressSeconds = std::chrono::duration<double>(middle - start).count(),
+            .decompressSeconds = std::chrono::duration<double>(end - middle).count(),
+            .absErrorSum = 0.0,
+            .relErrorSum = 0.0,
+            .squaredErrorSum = 0.0,
+            .absErrorMax = 0.0f,
+            .relErrorMax = 0.0f
+        };
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            const float absError = std::abs(chunk[i] - decompressed[i]);
+            const float relError = (chunk[i] != 0.0f) ? absError / std::abs(chunk[i]) : 0.0f;
+            sample.absErrorSum += absError;
+            sample.relErrorSum += relError;
+            sample.squaredErrorSum += static_cast<double>(absError) * absError;
+            sample.absErrorMax = std::max(sample.absErrorMax, absError);
+            sample.relErrorMax = std::max(sample.relErrorMax, relError);
+        }
+        samples.push_back(sample);
+    }
+
+    const double f = static_cast<double>(samples.size()) / numChunks;
+    constexpr double kBytesPerMB = 1024.0 * 1024.0;
+    auto numFloats = [](const ChunkSample& s) { return s.numFloats; };
+    auto originalMB = [&](const ChunkSample& s) { return s.originalBytes / kBytesPerMB; };
+
+    auto [ratio, ratioCI] = ratioEstimate(samples, f,
+        [](const ChunkSample& s) { return s.originalBytes; },
+        [](const ChunkSample& s) { return s.compressedBytes; });
+    auto [compThroughput, compThroughputCI] = ratioEstimate(samples, f,
+        originalMB, [](const ChunkSample& s) { return s.compressSeconds; });
+    auto [decompThroughput, decompThroughputCI] = ratioEstimate(samples, f,
+        originalMB, [](const ChunkSample& s) { return s.decompressSeconds; });
+    auto [absErrorAvg, absErrorAvgCI] = ratioEstimate(samples, f,
+        [](const ChunkSample& s) { return s.absErrorSum; }, numFloats);
+    auto [relErrorAvg, relErrorAvgCI] = ratioEstimate(samples, f,
+        [](const ChunkSample& s) { return s.relErrorSum; }, numFloats);
+    auto [mse, mseCI] = ratioEstimate(samples, f,
+        [](const ChunkSample& s) { return s.squaredErrorSum; }, numFloats);
+
+    float absErrorMax = 0.0f;
+    float relErrorMax = 0.0f;
+    for (const auto& s : samples) {
+        absErrorMax = std::max(absErrorMax, s.absErrorMax);
+        relErrorMax = std::max(relErrorMax, s.relErrorMax);
+    }
+
+    // Errors cannot be negative (NaN bounds stay NaN); PSNR decreases as MSE grows
+    absErrorAvgCI.lo = std::max(absErrorAvgCI.lo, 0.0);
+    relErrorAvgCI.lo = std::max(relErrorAvgCI.lo, 0.0);
+    mseCI.lo = std::max(mseCI.lo, 0.0);
+
+    // The dictionary is stored once per branch, on top of the extrapolated chunks
+    const std::size_t originalSizeBytes = data.size() * sizeof(float);
+    auto withDictionary = [&](double chunkRatio) {
+        return originalSizeBytes / (originalSizeBytes / chunkRatio + dictionaryBytes);
+    };
+    ratio = withDictionary(ratio);
+    ratioCI = {withDictionary(ratioCI.lo), withDictionary(ratioCI.hi)};
+    return {
+        .metrics = {
+            .originalSizeBytes = originalSizeBytes,
+            .compressedSizeBytes = static_cast<std::size_t>(std::llround(originalSizeBytes / ratio)),
+            .compressionRatio = static_cast<float>(ratio),
+            .compressionThroughputMbps = static_cast<float>(compThroughput),
+            .decompressionThroughputMbps = static_cast<float>(decompThroughput),
+            .absErrorMax = absErrorMax,
+            .absErrorAvg = static_cast<float>(absErrorAvg),
+            .relErrorMax = relErrorMax,
+            .relErrorAvg = static_cast<float>(relErrorAvg),
+            .MSE = static_cast<float>(mse),
+            .PSNR = psnrFromMSE(mse)
+        },
+        .originalSizeBytes = originalSizeBytes,
+        .compressedSizeBytes = static_cast<std::size_t>(std::llround(originalSizeBytes / ratio)),
+        .numChunks = numChunks,
+        .sampledChunks = samples.size(),
+        .confidenceLevel = 0.95,
+        .compressionRatio = ratioCI,
+        .compressionThroughputMbps = compThroughputCI,
+        .decompressionThroughputMbps = decompThroughputCI,
+        .absErrorAvg = absErrorAvgCI,
+        .relErrorAvg = relErrorAvgCI,
+        .MSE = mseCI,
+        .PSNR = {psnrFromMSE(mseCI.hi), psnrFromMSE(mseCI.lo)}
+    };
+}
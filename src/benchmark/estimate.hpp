@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "Compressor.hpp"
+
+// Two-sided confidence interval.
+struct Interval {
+    double lo;
+    double hi;
+};
+
+// Benchmark metrics extrapolated from a sample of chunks.
+struct EstimateResult {
+    // Point estimates; max errors are the maxima over the sample and so are
+    // lower bounds for the full branch.
+    BenchmarkResult metrics;
+
+    std::size_t originalSizeBytes{0};
+    // Extrapolated from the sample
+    std::size_t compressedSizeBytes{0};
+    std::size_t numChunks{0};
+    std::size_t sampledChunks{0};
+
+    double confidenceLevel{0.95};
+    Interval compressionRatio{};
+    Interval compressionThroughputMbps{};
+    Interval decompressionThroughputMbps{};
+    Interval absErrorAvg{};
+    Interval relErrorAvg{};
+    Interval MSE{};
+    Interval PSNR{};
+};
+
+// Compress and decompress a stratified random sample of chunks (see
+// sampleChunkIndices) and extrapolate branch-level metrics with 95%
+// confidence intervals. Ratio-type metrics (compression ratio, throughput,
+// mean errors) use the ratio estimator with a delta-method variance and a
+// finite population correction. With fewer than two sampled chunks, out of
+// more, the interval bounds are NaN (null in JSON). A compressor's shared dictionary is trained
+// on the sample, and its size is added to the extrapolated compressed size.
+EstimateResult estimateBenchmarkMetrics(
+    Compressor& compressor,
+    const std::vector<float>& data,
+    std::size_t chunkSize,
+    double sampleFraction,
+    std::uint64_t seed);
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "histogram.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Values binned per batch; bin indices are computed for a whole batch first,
+// which the compiler vectorizes, and then counted
+constexpr std::size_t kBatch = 1024;
+
+// Counts of original and reconstructed values: bin 0 is underflow, bins
+// 1..n are in range and bin n + 1 is overflow
+struct HistogramPair {
+    std::vector<std::uint64_t> original;
+    std::vector<std::uint64_t> reconstructed;
+};
+
+void computeBinIndices(
+    const float* values,
+    std::size_t count,
+    std::size_t stride,
+    double lo,
+    double scale,
+    std::uint32_t bins,
+    std::uint32_t* indices
+)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const double t = (static_cast<double>(values[i * stride]) - lo) * scale;
+        // !(t >= 0) also sends NaN to underflow
+        indices[i] = !(t >= 0.0) ? 0 : (t < bins ? static_cast<std::uint32_t>(t) + 1 : bins + 1);
+    }
+}
+
+void fillRange(
+    const float* original,
+    const float* reconstructed,
+    std::size_t stride,
+    std::size_t first,
+    std::size_t last,
+    double lo,
+    double scale,
+    std::uint32_t bins,
+    HistogramPair& histograms
+)
+{
+    std::uint32_t originalBins[kBatch];
+    std::uint32_t reconstructedBins[kBatch];
+    for (std::size_t start = first; start < last; start += kBatch) {
+        const std::size_t count = std::min(kBatch, last - start);
+        computeBinIndices(original + start * stride, count, stride, lo, scale, bins, originalBins);
+        computeBinIndices(reconstructed + start * stride, count, stride, lo, scale, bins, reconstructedBins);
+        for (std::size_t i = 0; i < count; ++i) {
+            ++histograms.original[originalBins[i]];
+            ++histograms.reconstructed[reconstructedBins[i]];
+        }
+    }
+}
+
+} // namespace
+
+HistogramComparison compareHistograms(
+    const std::vector<float>& original,
+    const std::vector<float>& reconstructed,
+    const HistogramBinning& binning,
+    std::size_t threads,
+    std::size_t stride,
+    std::size_t offset
+)
+{
+    if (original.size() != reconstructed.size()) {
+        throw std::invalid_argument("Original and reconstructed data size mismatch.");
+    }
+    if (binning.bins == 0 || binning.bins > std::numeric_limits<std::uint32_t>::max() - 2) {
+        throw std::invalid_argument("Histogram bin count out of range.");
+    }
+    stride = std::max<std::size_t>(1, stride);
+    const std::size_t numValues = original.size() > offset ? (original.size() - offset + stride - 1) / stride : 0;
+
+    // Default range: the finite original values
+    double lo = 0.0;
+    double hi = 0.0;
+    if (binning.range) {
+        std::tie(lo, hi) = *binning.range;
+    } else {
+        lo = std::numeric_limits<double>::infinity();
+        hi = -std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < numValues; ++i) {
+            const float value = original[offset + i * stride];
+            if (std::isfinite(value)) {
+                lo = std::min<double>(lo, value);
+                hi = std::max<double>(hi, value);
+            }
+        }
+        if (lo > hi) {
+            lo = hi = 0.0;
+        }
+        // Keep the maximum inside the last bin, and give constant data a non-empty range
+        hi = (hi > lo) ? std::nextafter(hi, std::numeric_limits<double>::infinity()) : lo + 1.0;
+    }
+    if (!(hi > lo)) {
+        throw std::invalid_argument("Histogram range must satisfy lo < hi.");
+    }
+
+    // Fill private histograms per thread, then merge
+    const auto bins = static_cast<std::uint32_t>(binning.bins);
+    const double scale = bins / (hi - lo);
+    threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(1, numValues / kBatch));
+    std::vector<HistogramPair> partial(threads, {
+        std::vector<std::uint64_t>(bins + 2, 0), std::vector<std::uint64_t>(bins + 2, 0)
+    });
+    const float* originalBase = original.data() + std::min(offset, original.size());
+    const float* reconstructedBase = reconstructed.data() + std::min(offset, reconstructed.size());
+    auto fill = [&](std::size_t t) {
+        const std::size_t first = t * numValues / threads;
+        const std::size_t last = (t + 1) * numValues / threads;
+        fillRange(originalBase, reconstructedBase, stride, first, last, lo, scale, bins, partial[t]);
+    };
+    parallelForRanges(threads, fill);
+    HistogramPair merged = std::move(partial.front());
+    for (std::size_t t = 1; t < threads; ++t) {
+        for (std::size_t b = 0; b < bins + 2; ++b) {
+            merged.original[b] += partial[t].original[b];
+            merged.reconstructed[b] += partial[t].reconstructed[b];
+        }
+    }
+
+    // Compare
+    HistogramComparison result{};
+    result.bins = bins;
+    result.lo = lo;
+    result.hi = hi;
+    result.originalUnderflow = merged.original.front();
+    result.originalOverflow = merged.original.back();
+    result.reconstructedUnderflow = merged.reconstructed.front();
+    result.reconstructedOverflow = merged.reconstructed.back();
+
+    const double total = std::max<std::size_t>(1, numValues);
+    double cumulativeDifference = 0.0;
+    std::size_t filledBins = 0;
+    for (std::size_t b = 0; b < bins + 2; ++b) {
+        const double o = static_cast<double>(merged.original[b]);
+        const double r = static_cast<double>(merged.reconstructed[b]);
+        cumulativeDifference += o - r;
+        result.ksDistance = std::max(result.ksDistance, std::abs(cumulativeDifference) / total);
+        result.maxBinDeviation = std::max(result.maxBinDeviation, std::abs(o - r) / total);
+        if (o > 0.0) {
+            result.maxBinRelDeviation = std::max(result.maxBinRelDeviation, std::abs(o - r) / o);
+        }
+        const bool inRange = b > 0 && b <= bins;
+        if (inRange && o + r > 0.0) {
+            result.chi2 += (o - r) * (o - r) / (o + r);
+            ++filledBins;
+        }
+    }
+    // Both histograms have the same number of entries, which removes one degree of freedom
+    result.ndf = filledBins > 0 ? filledBins - 1 : 0;
+    result.chi2PerNdf = result.ndf > 0 ? result.chi2 / result.ndf : 0.0;
+    return result;
+}
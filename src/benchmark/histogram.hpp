@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Uniform binning for distribution comparisons. Without an explicit range,
+// the range of the finite original values is used.
+struct HistogramBinning {
+    std::size_t bins{100};
+    std::optional<std::pair<double, double>> range;
+};
+
+// Comparison of the histograms of original and reconstructed values.
+// Out-of-range values go to underflow/overflow bins (NaN to underflow), which
+// take part in the KS distance but not in chi2.
+struct HistogramComparison {
+    std::size_t bins;
+    double lo;
+    double hi;
+
+    // Largest difference of the binned cumulative distributions
+    double ksDistance;
+    // Two-sample chi2 over bins with entries, and its degrees of freedom
+    double chi2;
+    std::size_t ndf;
+    double chi2PerNdf;
+    // Largest bin difference, as a fraction of all values and of the original bin content
+    double maxBinDeviation;
+    double maxBinRelDeviation;
+
+    std::size_t originalUnderflow;
+    std::size_t originalOverflow;
+    std::size_t reconstructedUnderflow;
+    std::size_t reconstructedOverflow;
+};
+
+// Fill original and reconstructed histograms in one pass over both arrays and
+// compare them. Only every stride-th value starting at offset is used, so one
+// field of an interleaved (values x fields) array can be compared in place.
+// The values are split across threads, each filling private histograms that
+// are merged at the end. Throws std::invalid_argument on mismatched sizes or
+// an empty range.
+HistogramComparison compareHistograms(
+    const std::vector<float>& original,
+    const std::vector<float>& reconstructed,
+    const HistogramBinning& binning,
+    std::size_t threads = 1,
+    std::size_t stride = 1,
+    std::size_t offset = 0);
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "layout.hpp"
+
+namespace {
+
+// Largest ratio of padded floats to values the padded layout accepts; a few
+// outlier entries would otherwise multiply the memory needed
+constexpr std::size_t kMaxPaddingFactor = 16;
+
+// Split rows of rowSize floats into chunks of whole rows.
+std::vector<std::vector<float>> splitIntoRowChunks(
+    const std::vector<float>& values,
+    std::size_t rowSize,
+    std::size_t chunkSize
+)
+{
+    const std::size_t rowsPerChunk = std::max<std::size_t>(1, chunkSize / (rowSize * sizeof(float)));
+    return splitIntoChunks(values, rowsPerChunk * rowSize * sizeof(float));
+}
+
+} // namespace
+
+LayoutChunks makeFlatLayout(
+    const std::vector<float>& values,
+    std::size_t chunkSize
+)
+{
+    return {
+        .chunks = splitIntoChunks(values, chunkSize),
+        .innerDims = {},
+        .mask = {},
+        .paddedFloats = values.size()
+    };
+}
+
+LayoutChunks makePaddedLayout(
+    const std::vector<float>& values,
+    const std::vector<std::uint32_t>& entrySizes,
+    std::size_t chunkSize
+)
+{
+    const std::uint32_t maxEntrySize = entrySizes.empty()
+        ? 0 : *std::max_element(entrySizes.begin(), entrySizes.end());
+    if (maxEntrySize == 0) {
+        return makeFlatLayout(values, chunkSize);
+    }
+
+    // Validate before allocating, so that rows never read past the values
+    std::size_t totalSize = 0;
+    for (std::uint32_t size : entrySizes) {
+        totalSize += size;
+    }
+    if (totalSize != values.size()) {
+        throw std::runtime_error(std::format(
+            "Entry sizes add up to {} values, but the branch has {}.", totalSize, values.size()));
+    }
+    const std::size_t paddedFloats = entrySizes.size() * maxEntrySize;
+    if (paddedFloats > kMaxPaddingFactor * values.size()) {
+        throw std::runtime_error(std::format(
+            "The padded layout would hold {} floats, more than {} times the {} values, because the "
+            "largest entry ({} values) is far above the mean. Use --layout flat for this branch.",
+            paddedFloats, kMaxPaddingFactor, values.size(), maxEntrySize));
+    }
+
+    std::vector<float> padded;
+    padded.reserve(paddedFloats);
+    std::vector<std::uint8_t> mask((paddedFloats + 7) / 8, 0);
+
+    std::size_t next = 0;
+    for (std::uint32_t size : entrySizes) {
+        const std::size_t rowStart = padded.size();
+        padded.insert(padded.end(), values.begin() + next, values.begin() + next + size);
+        for (std::size_t i = rowStart; i < rowStart + size; ++i) {
+            mask[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+        }
+        // Repeating the last value keeps the padding cheap for predictors
+        const float fill = (size > 0) ? values[next + size - 1] : 0.0f;
+        padded.resize(rowStart + maxEntrySize, fill);
+        next += size;
+    }
+
+    return {
+        .chunks = splitIntoRowChunks(padded, maxEntrySize, chunkSize),
+        .innerDims = {maxEntrySize},
+        .mask = std::move(mask),
+        .paddedFloats = paddedFloats
+    };
+}
+
+LayoutChunks makeFieldsLayout(
+    const std::vector<float>& interleaved,
+    std::size_t numFields,
+    std::size_t chunkSize
+)
+{
+    return {
+        .chunks = splitIntoRowChunks(interleaved, numFields, chunkSize),
+        .innerDims = {numFields},
+        .mask = {},
+        .paddedFloats = interleaved.size()
+    };
+}
+
+std::vector<float> interleaveFields(const std::vector<std::vector<float>>& fields) {
+    if (fields.empty()) {
+        throw std::runtime_error("The fields layout needs at least one branch.");
+    }
+    const std::size_t numFields = fields.size();
+    const std::size_t numValues = numFields ? fields.front().size() : 0;
+    for (const auto& field : fields) {
+        if (field.size() != numValues) {
+            throw std::runtime_error("All branches in the fields layout must have the same number of values.");
+        }
+    }
+
+    std::vector<float> interleaved(numValues * numFields);
+    for (std::size_t f = 0; f < numFields; ++f) {
+        for (std::size_t i = 0; i < numValues; ++i) {
+            interleaved[i * numFields + f] = fields[f][i];
+        }
+    }
+    return interleaved;
+}
+
+std::vector<float> removePadding(
+    const std::vector<float>& padded,
+    const std::vector<std::uint8_t>& mask
+)
+{
+    std::vector<float> values;
+    values.reserve(padded.size());
+    for (std::size_t i = 0; i < padded.size(); ++i) {
+        if (mask[i / 8] & (1u << (i % 8))) {
+            values.push_back(padded[i]);
+        }
+    }
+    return values;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How branch values are arranged before compression.
+//   flat:   values in entry order, compressed as 1D chunks
+//   padded: each entry becomes a row padded to the largest entry size,
+//           giving an (entries x maxEntrySize) array plus a validity mask
+//   fields: several branches of equal length are interleaved, giving an
+//           (values x branches) array
+struct LayoutChunks {
+    std::vector<std::vector<float>> chunks;
+    // Trailing dimensions of every chunk; empty for 1D
+    std::vector<std::size_t> innerDims;
+    // Bit-packed validity of each padded value (padded layout only).
+    // Stored alongside the compressed chunks (also in containers), so it counts
+    // toward the compressed size.
+    std::vector<std::uint8_t> mask;
+    // Number of floats handed to the compressor, including padding
+    std::size_t paddedFloats{0};
+};
+
+// Split flattened values into 1D chunks of at most chunkSize bytes.
+LayoutChunks makeFlatLayout(
+    const std::vector<float>& values,
+    std::size_t chunkSize);
+
+// Arrange jagged values as rows of maxEntrySize, padding each row with its
+// last valid value (0 for empty entries). Chunks hold whole rows and are at
+// most chunkSize bytes unless a single row is larger. Throws
+// std::runtime_error if the entry sizes do not add up to the number of values,
+// or if padding would make the array more than 16 times larger.
+LayoutChunks makePaddedLayout(
+    const std::vector<float>& values,
+    const std::vector<std::uint32_t>& entrySizes,
+    std::size_t chunkSize);
+
+// Split values already interleaved by interleaveFields into chunks of whole
+// rows of one value per field.
+LayoutChunks makeFieldsLayout(
+    const std::vector<float>& interleaved,
+    std::size_t numFields,
+    std::size_t chunkSize);
+
+// Interleave equally sized fields value by value.
+// Throws std::runtime_error if there are none or their sizes differ.
+std::vector<float> interleaveFields(const std::vector<std::vector<float>>& fields);
+
+// Drop padded values from a decompressed padded layout, using its mask.
+std::vector<float> removePadding(
+    const std::vector<float>& padded,
+    const std::vector<std::uint8_t>& mask);
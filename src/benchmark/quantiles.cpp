@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+#include "quantiles.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Buffered values per unit of compression before they are merged
+constexpr double kBufferFactor = 10.0;
+
+// k1 scale function and its inverse: centroids are small near q = 0 and q = 1
+double kFromQ(double q, double compression) {
+    return compression / (2.0 * std::numbers::pi) * std::asin(2.0 * std::clamp(q, 0.0, 1.0) - 1.0);
+}
+
+double qFromK(double k, double compression) {
+    const double angle = std::clamp(2.0 * std::numbers::pi * k / compression,
+                                    -std::numbers::pi / 2.0, std::numbers::pi / 2.0);
+    return (std::sin(angle) + 1.0) / 2.0;
+}
+
+} // namespace
+
+TDigest::TDigest(double compression)
+    : _compression(compression),
+      _min(std::numeric_limits<double>::infinity()),
+      _max(-std::numeric_limits<double>::infinity())
+{
+    if (!(compression >= 10.0)) {
+        throw std::invalid_argument("t-digest compression must be at least 10");
+    }
+    _buffer.reserve(static_cast<std::size_t>(kBufferFactor * compression));
+}
+
+void TDigest::add(double value, double weight) {
+    if (std::isnan(value) || weight <= 0.0) {
+        return;
+    }
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+    _buffer.push_back({value, weight});
+    if (_buffer.size() >= kBufferFactor * _compression) {
+        compress();
+    }
+}
+
+void TDigest::merge(const TDigest& other) {
+    other.compress();
+    for (const auto& centroid : other._centroids) {
+        add(centroid.mean, centroid.weight);
+    }
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+void TDigest::compress() const {
+    if (_buffer.empty()) {
+        return;
+    }
+    _buffer.insert(_buffer.end(), _centroids.begin(), _centroids.end());
+    std::sort(_buffer.begin(), _buffer.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+    double total = 0.0;
+    for (const auto& centroid : _buffer) {
+        total += centroid.weight;
+    }
+
+    // Greedily merge neighbours while the merged centroid spans at most one unit of k
+    _centroids.clear();
+    double weightSoFar = 0.0;
+    double weightLimit = total * qFromK(kFromQ(0.0, _compression) + 1.0, _compression);
+    Centroid current = _buffer.front();
+    for (std::size_t i = 1; i < _buffer.size(); ++i) {
+        const Centroid& next = _buffer[i];
+        if (weightSoFar + current.weight + next.weight <= weightLimit) {
+            current.mean += (next.mean - current.mean) * next.weight / (current.weight + next.weight);
+            current.weight += next.weight;
+        } else {
+            weightSoFar += current.weight;
+            _centroids.push_back(current);
+            weightLimit = total * qFromK(kFromQ(weightSoFar / total, _compression) + 1.0, _compression);
+            current = next;
+        }
+    }
+    _centroids.push_back(current);
+    _buffer.clear();
+}
+
+double TDigest::quantile(double q) const {
+    compress();
+    if (_centroids.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (_centroids.size() == 1) {
+        return _centroids.front().mean;
+    }
+
+    const double total = count();
+    const double index = std::clamp(q, 0.0, 1.0) * total;
+
+    // Interpolate between centroid centres, and towards min/max at the ends
+    const Centroid& first = _centroids.front();
+    if (index < first.weight / 2.0) {
+        return _min + (first.mean - _min) * index / (first.weight / 2.0);
+    }
+    double weightSoFar = 0.0;
+    for (std::size_t i = 0; i + 1 < _centroids.size(); ++i) {
+        const Centroid& left = _centroids[i];
+        const Centroid& right = _centroids[i + 1];
+        const double leftCentre = weightSoFar + left.weight / 2.0;
+        const double rightCentre = weightSoFar + left.weight + right.weight / 2.0;
+        if (index <= rightCentre) {
+            return left.mean + (right.mean - left.mean) * (index - leftCentre) / (rightCentre - leftCentre);
+        }
+        weightSoFar += left.weight;
+    }
+    const Centroid& last = _centroids.back();
+    const double lastCentre = total - last.weight / 2.0;
+    return last.mean + (_max - last.mean) * (index - lastCentre) / (last.weight / 2.0);
+}
+
+double TDigest::count() const {
+    compress();
+    double total = 0.0;
+    for (const auto& centroid : _centroids) {
+        total += centroid.weight;
+    }
+    return total;
+}
+
+std::size_t TDigest::numCentroids() const {
+    compress();
+    return _centroids.size();
+}
+
+ErrorQuantiles computeErrorQuantiles(
+    const std::vector<float>& original,
+    const std::vector<float>& reconstructed,
+    std::size_t blockFloats,
+    std::size_t threads,
+    const std::vector<double>& probabilities,
+    double compression
+)
+{
+    if (original.size() != reconstructed.size()) {
+        throw std::invalid_argument("Original and reconstructed data size mismatch.");
+    }
+    blockFloats = std::max<std::size_t>(1, blockFloats);
+    const std::size_t numBlocks = (original.size() + blockFloats - 1) / blockFloats;
+    threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(1, numBlocks));
+
+    struct Digests {
+        TDigest abs;
+        TDigest rel;
+    };
+    std::vector<Digests> perThread(threads, {TDigest(compression), TDigest(compression)});
+    auto sketch = [&](std::size_t t) {
+        for (std::size_t block = t * numBlocks / threads; block < (t + 1) * numBlocks / threads; ++block) {
+            Digests blockDigests{TDigest(compression), TDigest(compression)};
+            const std::size_t end = std::min(original.size(), (block + 1) * blockFloats);
+            for (std::size_t i = block * blockFloats; i < end; ++i) {
+                const float absError = std::abs(original[i] - reconstructed[i]);
+                blockDigests.abs.add(absError);
+                blockDigests.rel.add((original[i] != 0.0f) ? absError / std::abs(original[i]) : 0.0f);
+            }
+            perThread[t].abs.merge(blockDigests.abs);
+            perThread[t].rel.merge(blockDigests.rel);
+        }
+    };
+    parallelForRanges(threads, sketch);
+
+    Digests merged{TDigest(compression), TDigest(compression)};
+    for (const auto& digests : perThread) {
+        merged.abs.merge(digests.abs);
+        merged.rel.merge(digests.rel);
+    }
+
+    ErrorQuantiles result{.probabilities = probabilities, .absError = {}, .relError = {}, .compression = compression};
+    for (double p : probabilities) {
+        result.absError.push_back(merged.abs.quantile(p));
+        result.relError.push_back(merged.rel.quantile(p));
+    }
+    return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Mergeable streaming quantile sketch (merging t-digest with the k1 scale
+// function). Memory is bounded by the compression parameter, independent of
+// the number of values added; accuracy is best near the tails. Near quantile
+// q a centroid holds about a fraction 2*pi*sqrt(q*(1-q))/compression of the
+// values, so the default of 1000 resolves p99.9 to about 0.02% of the values.
+class TDigest {
+public:
+    explicit TDigest(double compression = 1000.0);
+
+    void add(double value, double weight = 1.0);
+
+    // Add all values summarized by another digest.
+    void merge(const TDigest& other);
+
+    // Estimated value at quantile q in [0, 1]; NaN if the digest is empty.
+    double quantile(double q) const;
+
+    // Total weight added.
+    double count() const;
+
+    // Number of centroids after compressing buffered values.
+    std::size_t numCentroids() const;
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    // Merge buffered values into the centroids.
+    void compress() const;
+
+    double _compression;
+    double _min;
+    double _max;
+    // Compression is deferred until the buffer fills or the digest is queried
+    mutable std::vector<Centroid> _centroids;
+    mutable std::vector<Centroid> _buffer;
+};
+
+// Quantiles of the pointwise reconstruction error.
+struct ErrorQuantiles {
+    std::vector<double> probabilities;
+    std::vector<double> absError;
+    std::vector<double> relError;
+    double compression;
+};
+
+// Sketch absolute and relative error (as in computeBenchmarkMetrics) with
+// t-digests: one per block of blockFloats values, merged into one per thread,
+// then merged into the result. Threads take contiguous ranges of blocks.
+// Throws std::invalid_argument on mismatched sizes.
+ErrorQuantiles computeErrorQuantiles(
+    const std::vector<float>& original,
+    const std::vector<float>& reconstructed,
+    std::size_t blockFloats,
+    std::size_t threads = 1,
+    const std::vector<double>& probabilities = {0.5, 0.9, 0.99, 0.999},
+    double compression = 1000.0);
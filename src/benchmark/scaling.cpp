@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "platform.hpp"
+#include "scaling.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Compress and then decompress the chunks with one clone of compressor per
+// thread, each clone taking a contiguous range of chunks. Only the work on the
+// chunks is timed, not starting the pool or making the clones.
+std::pair<CompressionResult, DecompressionResult> runChunkParallel(
+    const Compressor& compressor,
+    const std::vector<std::vector<float>>& chunks,
+    std::size_t threads,
+    const std::function<void(std::size_t)>& onWorkerStart
+)
+{
+    ThreadPool pool(threads, onWorkerStart);
+    std::vector<std::unique_ptr<Compressor>> clones;
+    for (std::size_t t = 0; t < threads; ++t) {
+        clones.push_back(compressor.clone());
+    }
+    auto forEachRange = [&](auto&& process) {
+        std::vector<std::future<void>> pending;
+        for (std::size_t t = 0; t < threads; ++t) {
+            pending.push_back(pool.submit([&process, &clones, &chunks, threads, t]() {
+                const std::size_t first = t * chunks.size() / threads;
+                const std::size_t last = (t + 1) * chunks.size() / threads;
+                for (std::size_t i = first; i < last; ++i) {
+                    process(*clones[t], i);
+                }
+            }));
+        }
+        for (auto& done : pending) {
+            done.get();
+        }
+    };
+
+    CompressionResult comp;
+    comp.compressedChunks.resize(chunks.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    forEachRange([&](Compressor& clone, std::size_t i) {
+        comp.compressedChunks[i] = clone.compress(chunks[i]);
+    });
+    comp.elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    // Output slices are assigned up front and faulted in before timing
+    std::vector<std::size_t> offsets(chunks.size() + 1, 0);
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        offsets[i + 1] = offsets[i] + comp.compressedChunks[i].numFloats;
+    }
+    DecompressionResult decomp;
+    decomp.decompressedData.resize(offsets.back());
+    start = std::chrono::high_resolution_clock::now();
+    forEachRange([&](Compressor& clone, std::size_t i) {
+        const CompressedData& chunk = comp.compressedChunks[i];
+        clone.decompressInto(chunk.data, std::span(decomp.decompressedData).subspan(offsets[i], chunk.numFloats));
+    });
+    decomp.elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    return {std::move(comp), std::move(decomp)};
+}
+
+} // namespace
+
+std::vector<std::size_t> scalingThreadCounts(std::size_t maxThreads) {
+    std::vector<std::size_t> counts;
+    for (std::size_t threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(std::max<std::size_t>(1, maxThreads));
+    return counts;
+}
+
+std::vector<ScalingStep> runScalingSweep(
+    const Compressor& compressor,
+    const std::vector<float>& data,
+    std::size_t chunkSize,
+    const std::vector<std::size_t>& threadCounts,
+    const std::function<void(std::size_t)>& onWorkerStart
+)
+{
+    const std::vector<std::vector<float>> chunks{splitIntoChunks(data, chunkSize)};
+
+    // Warm-up: maps the scratch buffers and trains the dictionary, if any
+    std::unique_ptr<Compressor> trained = compressor.clone();
+    const bool internal = trained->setThreads(1);
+    const CompressionResult warmup{timedCompress(*trained, chunks)};
+    timedDecompress(*trained, warmup.compressedChunks);
+
+    std::vector<ScalingStep> steps;
+    for (std::size_t threads : threadCounts) {
+        ScalingStep step;
+        step.threads = threads;
+        step.parallelism = internal ? "internal" : "chunks";
+
+        CompressionResult comp;
+        DecompressionResult decomp;
+        if (internal) {
+            std::unique_ptr<Compressor> parallel = trained->clone();
+            parallel->setThreads(threads);
+            comp = timedCompress(*parallel, chunks);
+            decomp = timedDecompress(*parallel, comp.compressedChunks);
+            step.compressorConfig = parallel->getConfig();
+        } else {
+            std::tie(comp, decomp) = runChunkParallel(*trained, chunks, threads, onWorkerStart);
+            comp.dictionary = warmup.dictionary;
+            step.compressorConfig = trained->getConfig();
+        }
+
+        step.metrics = computeBenchmarkMetrics(data, comp, decomp);
+        step.numChunks = comp.compressedChunks.size();
+        step.cpus = currentThreadAffinity();
+        step.compressElapsed = comp.elapsed;
+        step.decompressElapsed = decomp.elapsed;
+        steps.push_back(std::move(step));
+    }
+
+    // Scaling relative to the first step
+    if (!steps.empty()) {
+        const ScalingStep& first = steps.front();
+        for (auto& step : steps) {
+            const double scale = static_cast<double>(first.threads) / step.threads;
+            step.compressSpeedup = first.compressElapsed / step.compressElapsed;
+            step.decompressSpeedup = first.decompressElapsed / step.decompressElapsed;
+            step.compressEfficiency = step.compressSpeedup * scale;
+            step.decompressEfficiency = step.decompressSpeedup * scale;
+            step.ratioChange = step.metrics.compressionRatio / first.metrics.compressionRatio - 1.0;
+        }
+    }
+    return steps;
+}
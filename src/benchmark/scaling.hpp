@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "Compressor.hpp"
+
+// One thread count of a scaling sweep.
+struct ScalingStep {
+    std::size_t threads{1};
+    // "internal" if the compressor parallelized each call (Compressor::setThreads),
+    // "chunks" if the chunks were spread over one compressor clone per thread
+    std::string parallelism;
+    // Configuration as run, including the thread count for internal parallelism
+    std::map<std::string, std::string> compressorConfig;
+    BenchmarkResult metrics;
+    std::size_t numChunks{0};
+    // Affinity of the calling thread during the step; threads started by the
+    // compressor inherit it, so internal parallelism is limited to these CPUs
+    std::vector<int> cpus;
+    std::chrono::duration<double, std::milli> compressElapsed{0};
+    std::chrono::duration<double, std::milli> decompressElapsed{0};
+
+    // Relative to the first step (normally one thread): time ratio, speedup
+    // per thread, and relative change of the compression ratio
+    double compressSpeedup{1.0};
+    double decompressSpeedup{1.0};
+    double compressEfficiency{1.0};
+    double decompressEfficiency{1.0};
+    double ratioChange{0.0};
+};
+
+// Thread counts 1, 2, 4, ... below maxThreads, then maxThreads itself.
+std::vector<std::size_t> scalingThreadCounts(std::size_t maxThreads);
+
+// Compress and decompress data in chunks of chunkSize bytes at each thread
+// count, after one untimed warm-up run. Call it from a thread whose affinity
+// covers all CPUs to be used (see ScalingStep::cpus). Compressors with internal parallelism
+// get the thread count through Compressor::setThreads(); for the others,
+// contiguous ranges of chunks are processed concurrently by clones on a
+// ThreadPool whose workers call onWorkerStart (e.g. to pin themselves). A
+// dictionary is trained once, in the warm-up, and shared by the clones.
+std::vector<ScalingStep> runScalingSweep(
+    const Compressor& compressor,
+    const std::vector<float>& data,
+    std::size_t chunkSize,
+    const std::vector<std::size_t>& threadCounts,
+    const std::function<void(std::size_t)>& onWorkerStart = {});
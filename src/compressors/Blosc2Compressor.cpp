@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include <blosc2.h>
+
+#include "Blosc2Compressor.hpp"
+#include "CompressedOutput.hpp"
+
+namespace {
+
+const std::map<std::string, int> kCodecs = {
+    {"blosclz", BLOSC_BLOSCLZ},
+    {"lz4", BLOSC_LZ4},
+    {"lz4hc", BLOSC_LZ4HC},
+    {"zlib", BLOSC_ZLIB},
+    {"zstd", BLOSC_ZSTD},
+};
+
+const std::map<std::string, int> kFilters = {
+    {"shuffle", BLOSC_SHUFFLE},
+    {"bitshuffle", BLOSC_BITSHUFFLE},
+    {"delta", BLOSC_DELTA},
+    {"trunc_prec", BLOSC_TRUNC_PREC},
+};
+
+// Filters are given as a '+'-separated pipeline, e.g. "delta+shuffle"; "none" disables filtering.
+std::vector<std::string> parseFilters(const std::string& value) {
+    std::vector<std::string> filters;
+    if (value == "none") {
+        return filters;
+    }
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        const std::size_t pos = std::min(value.find('+', start), value.size());
+        filters.push_back(value.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return filters;
+}
+
+void freeContext(blosc2_context* ctx) {
+    if (ctx) {
+        blosc2_free_ctx(ctx);
+    }
+}
+
+} // namespace
+
+Blosc2Compressor::Blosc2Compressor() : _cctx(nullptr, freeContext), _dctx(nullptr, freeContext) {
+    // Blosc2 global state is initialized once per process
+    static std::once_flag initialized;
+    std::call_once(initialized, [] { blosc2_init(); });
+    createContexts();
+}
+
+void Blosc2Compressor::createContexts() {
+    blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+    cparams.compcode = static_cast<uint8_t>(kCodecs.at(_codec));
+    cparams.clevel = static_cast<uint8_t>(_compressionLevel);
+    cparams.typesize = sizeof(float);
+    cparams.nthreads = static_cast<int16_t>(_nthreads);
+    cparams.blocksize = _blockSize;
+    for (int i = 0; i < BLOSC2_MAX_FILTERS; ++i) {
+        cparams.filters[i] = BLOSC_NOFILTER;
+        cparams.filters_meta[i] = 0;
+    }
+    for (std::size_t i = 0; i < _filters.size(); ++i) {
+        cparams.filters[i] = static_cast<uint8_t>(kFilters.at(_filters[i]));
+        if (_filters[i] == "trunc_prec") {
+            cparams.filters_meta[i] = static_cast<uint8_t>(_truncPrecision);
+        }
+    }
+
+    blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+    dparams.nthreads = static_cast<int16_t>(_nthreads);
+
+    _cctx.reset(blosc2_create_cctx(cparams));
+    _dctx.reset(blosc2_create_dctx(dparams));
+    if (!_cctx || !_dctx) {
+        throw std::runtime_error("Failed to create Blosc2 contexts.");
+    }
+}
+
+CompressedData Blosc2Compressor::compress(const std::vector<float>& data) {
+    return compressViaScratch(*this, data);
+}
+
+std::size_t Blosc2Compressor::maxCompressedSize(std::size_t numFloats) const {
+    return numFloats * sizeof(float) + BLOSC2_MAX_OVERHEAD;
+}
+
+std::size_t Blosc2Compressor::compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) {
+    // Setup
+    const std::size_t inputSize = data.size() * sizeof(float);
+    if (inputSize > static_cast<std::size_t>(std::numeric_limits<int32_t>::max() - BLOSC2_MAX_OVERHEAD)) {
+        throw std::runtime_error("Blosc2 chunks are limited to 2 GB; use a smaller chunkSize.");
+    }
+
+    // Compress
+    const int res = blosc2_compress_ctx(
+        _cctx.get(),
+        data.data(),
+        static_cast<int32_t>(inputSize),
+        output.data(),
+        static_cast<int32_t>(std::min<std::size_t>(output.size(), std::numeric_limits<int32_t>::max()))
+    );
+
+    // Error checking
+    if (res <= 0) {
+        throw std::runtime_error("Blosc2 compression failed with error code: " + std::to_string(res));
+    }
+    return static_cast<std::size_t>(res);
+}
+
+std::vector<float> Blosc2Compressor::decompress(const CompressedData& compressedData) {
+    return decompressBytes(compressedData.data, compressedData.numFloats);
+}
+
+std::vector<float> Blosc2Compressor::decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) {
+    std::vector<float> decompressedData(numFloats);
+    decompressInto(bytes, decompressedData);
+    return decompressedData;
+}
+
+void Blosc2Compressor::decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) {
+    const auto outputBytes = static_cast<int32_t>(output.size_bytes());
+
+    // Decompress
+    const int res = blosc2_decompress_ctx(
+        _dctx.get(),
+        bytes.data(),
+        static_cast<int32_t>(bytes.size()),
+        output.data(),
+        outputBytes
+    );
+
+    // Error checking
+    if (res != outputBytes) {
+        throw std::runtime_error("Blosc2 decompression failed with error code: " + std::to_string(res));
+    }
+}
+
+bool Blosc2Compressor::setThreads(std::size_t threads) {
+    _nthreads = static_cast<int>(std::clamp<std::size_t>(threads, 1, std::numeric_limits<int16_t>::max()));
+    createContexts();
+    return true;
+}
+
+void Blosc2Compressor::configure(const std::map<std::string, std::string>& options) {
+    for (const auto& [key, value] : options) {
+        if (key == "codec") {
+            _codec = value;
+
+            // Validate
+            if (!kCodecs.contains(_codec)) {
+                throw std::invalid_argument("Invalid Blosc2 codec: " + value + ". Must be blosclz, lz4, lz4hc, zlib or zstd.");
+            }
+        } else if (key == "compressionLevel") {
+            _compressionLevel = std::stoi(value);
+
+            // Validate
+            if (_compressionLevel < 0 || _compressionLevel > 9) {
+                throw std::invalid_argument("Invalid Blosc2 compression level: " + value + ". Must be between 0 and 9.");
+            }
+        } else if (key == "filters") {
+            _filters = parseFilters(value);
+
+            // Validate
+            if (_filters.size() > BLOSC2_MAX_FILTERS) {
+                throw std::invalid_argument("Too many Blosc2 filters: " + value + ".");
+            }
+            for (const auto& filter : _filters) {
+                if (!kFilters.contains(filter)) {
+                    throw std::invalid_argument("Invalid Blosc2 filter: " + filter + ". Must be shuffle, bitshuffle, delta or trunc_prec.");
+                }
+            }
+        } else if (key == "truncPrecision") {
+            _truncPrecision = std::stoi(value);
+
+            // Validate
+            if (_truncPrecision < 1 || _truncPrecision > 23) {
+                throw std::invalid_argument("Invalid Blosc2 truncPrecision: " + value + ". Must be between 1 and 23.");
+            }
+        } else if (key == "blockSize") {
+            _blockSize = std::stoi(value);
+
+            // Validate
+            if (_blockSize < 0) {
+                throw std::invalid_argument("Invalid Blosc2 blockSize: " + value + ". Must be non-negative.");
+            }
+        } else if (key == "nthreads") {
+            _nthreads = std::stoi(value);
+
+            // Validate
+            if (_nthreads < 1 || _nthreads > std::numeric_limits<int16_t>::max()) {
+                throw std::invalid_argument("Invalid Blosc2 nthreads: " + value + ". Must be positive.");
+            }
+        }
+    }
+
+    createContexts();
+}
+
+std::unique_ptr<Compressor> Blosc2Compressor::clone() const {
+    // Contexts cannot be shared, so build fresh ones from the same settings
+    auto copy = std::make_unique<Blosc2Compressor>();
+    copy->configure(getConfig());
+    return copy;
+}
+
+std::map<std::string, std::string> Blosc2Compressor::getConfig() const {
+    std::string filters;
+    for (const auto& filter : _filters) {
+        filters += (filters.empty() ? "" : "+") + filter;
+    }
+
+    return {
+        {"codec", _codec},
+        {"compressionLevel", std::to_string(_compressionLevel)},
+        {"filters", filters.empty() ? "none" : filters},
+        {"truncPrecision", std::to_string(_truncPrecision)},
+        {"blockSize", std::to_string(_blockSize)},
+        {"nthreads", std::to_string(_nthreads)}
+    };
+}
+
+std::string Blosc2Compressor::name() const {
+    return "blosc2";
+}
+
+std::string Blosc2Compressor::description() const {
+    return "Blocked, multi-threaded meta-compressor with filters using Blosc2.";
+}
+
+std::string Blosc2Compressor::version() const {
+    return std::format("blosc2 {}", BLOSC2_VERSION_STRING);
+}
+
+std::string Blosc2Compressor::usage() const {
+    return "Options:\n"
+           "  codec=<blosclz|lz4|lz4hc|zlib|zstd>  Internal codec. Default is blosclz.\n"
+           "  compressionLevel=<int>  Compression level (0-9). Default is 5.\n"
+           "  filters=<f1+f2+...>     Filter pipeline, applied in order, from shuffle, bitshuffle,\n"
+           "                          delta and trunc_prec; or none. Default is shuffle.\n"
+           "  truncPrecision=<int>    Mantissa bits kept by trunc_prec (1-23). Default is 23.\n"
+           "  blockSize=<int>         Block size in bytes; 0 lets Blosc2 choose. Default is 0.\n"
+           "  nthreads=<int>          Compression and decompression threads. Default is 1.";
+}
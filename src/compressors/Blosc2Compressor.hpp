@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Compressor.hpp"
+
+struct blosc2_context_s;
+
+class Blosc2Compressor : public Compressor {
+public:
+    Blosc2Compressor();
+
+    CompressedData compress(const std::vector<float>& data) override;
+    std::size_t maxCompressedSize(std::size_t numFloats) const override;
+    std::size_t compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) override;
+    std::vector<float> decompress(const CompressedData& compressedData) override;
+    std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) override;
+    void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) override;
+    bool setThreads(std::size_t threads) override;
+    void configure(const std::map<std::string, std::string>& options) override;
+    std::unique_ptr<Compressor> clone() const override;
+    std::map<std::string, std::string> getConfig() const override;
+    std::string name() const override;
+    std::string description() const override;
+    std::string version() const override;
+    std::string usage() const override;
+
+private:
+    using ContextPtr = std::unique_ptr<blosc2_context_s, void (*)(blosc2_context_s*)>;
+
+    // (Re)create compression and decompression contexts from the current settings.
+    void createContexts();
+
+    std::string _codec = "blosclz";         // blosclz, lz4, lz4hc, zlib or zstd
+    int _compressionLevel = 5;              // 0-9
+    std::vector<std::string> _filters = {"shuffle"}; // Applied in order
+    int _truncPrecision = 23;               // Mantissa bits kept by trunc_prec
+    int _blockSize = 0;                     // Bytes; 0 lets Blosc2 choose
+    int _nthreads = 1;
+
+    // Contexts own Blosc2's worker threads, so they are reused across chunks
+    ContextPtr _cctx;
+    ContextPtr _dctx;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BufferPool.hpp"
+#include "Compressor.hpp"
+
+// compress() in terms of compressInto(), for compressors that know their
+// bound: compress into pooled scratch of maxCompressedSize() bytes and copy
+// the compressed bytes out.
+inline CompressedData compressViaScratch(Compressor& compressor, const std::vector<float>& data) {
+    const PooledBuffer scratch = BufferPool::global().acquire(compressor.maxCompressedSize(data.size()));
+    const std::size_t size = compressor.compressInto(data, scratch.bytes());
+    return {
+        .data = std::vector<std::uint8_t>(scratch.data(), scratch.data() + size),
+        .numFloats = data.size()
+    };
+}
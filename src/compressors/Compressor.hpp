@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -15,7 +19,9 @@ struct CompressedData{
 // Implementations must provide:
 //     a way to compress float data to bytes, 
 //     a way to restore compressed byte data to floats
-//     a way to parse configuration args.
+//     a way to parse configuration args
+//     a way to copy themselves, configuration included.
+// A single instance is not thread-safe; use clone() to get one per thread.
 class Compressor {
 public:
     virtual ~Compressor() = default;
@@ -26,9 +32,118 @@ public:
     // Decompress a byte buffer back into floats.
     virtual std::vector<float> decompress(const CompressedData& compressedData) = 0;
 
+    // Decompress from a borrowed byte range (e.g. a memory-mapped file) without
+    // first copying it into a CompressedData. The default implementation makes
+    // that copy; compressors that can read directly from the range override it.
+    virtual std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) {
+        CompressedData compressedData{
+            .data = std::vector<std::uint8_t>(bytes.begin(), bytes.end()),
+            .numFloats = numFloats
+        };
+        return decompress(compressedData);
+    }
+
+    // Decompress a borrowed byte range into caller-owned memory (e.g. a slice of
+    // a preallocated, already faulted-in output array), which must hold exactly
+    // the number of floats the range represents. The default implementation
+    // decompresses into a new vector and copies it; compressors that can write
+    // to the output directly override it.
+    virtual void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) {
+        const std::vector<float> values = decompressBytes(bytes, output.size());
+        std::copy(values.begin(), values.end(), output.begin());
+    }
+
+    // Upper bound on the compressed size of numFloats floats in bytes, or 0 if
+    // the compressor cannot tell in advance.
+    virtual std::size_t maxCompressedSize(std::size_t numFloats) const {
+        (void)numFloats;
+        return 0;
+    }
+
+    // Compress into caller-owned memory (e.g. a slice of a preallocated,
+    // already faulted-in arena) of at least maxCompressedSize() bytes, and
+    // return the compressed size. The default implementation copies
+    // compress(data) and throws std::length_error if it does not fit;
+    // compressors that know their bound write to the output directly.
+    virtual std::size_t compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) {
+        const CompressedData compressedData = compress(data);
+        if (compressedData.data.size() > output.size()) {
+            throw std::length_error("Compressed chunk does not fit its output buffer.");
+        }
+        std::copy(compressedData.data.begin(), compressedData.data.end(), output.begin());
+        return compressedData.data.size();
+    }
+
+    // Compress a sequence of chunks into outputs, one per chunk, storing each
+    // compressed size in sizes. Equivalent to calling compressInto() on each;
+    // compressors whose per-chunk work is statically dispatched (see
+    // pipeline.hpp) override it to pay for one virtual call per batch rather
+    // than per chunk.
+    virtual void compressChunksInto(
+        std::span<const std::vector<float>> chunks,
+        std::span<const std::span<std::uint8_t>> outputs,
+        std::span<std::size_t> sizes)
+    {
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            sizes[i] = compressInto(chunks[i], outputs[i]);
+        }
+    }
+
+    // Decompress a sequence of chunks into consecutive ranges of output, which
+    // must hold the sum of their numFloats. Equivalent to calling
+    // decompressInto() on each.
+    virtual void decompressChunksInto(std::span<const CompressedData> chunks, std::span<float> output) {
+        std::size_t offset = 0;
+        for (const auto& chunk : chunks) {
+            decompressInto(chunk.data, output.subspan(offset, chunk.numFloats));
+            offset += chunk.numFloats;
+        }
+    }
+
+    // Hint that each buffer passed to compress() is a row-major array whose
+    // trailing dimensions are innerDims; the leading dimension follows from the
+    // buffer size. Compressors without multi-dimensional predictors ignore it.
+    virtual void setInnerDims(const std::vector<std::size_t>& innerDims) {
+        (void)innerDims;
+    }
+
+    // Use up to threads threads inside each compress() and decompress() call
+    // (e.g. OpenMP threads or the codec's workers); 1 is serial. Returns false,
+    // leaving the configuration unchanged, if the compressor has no internal
+    // parallelism. The thread count is part of getConfig().
+    virtual bool setThreads(std::size_t threads) {
+        (void)threads;
+        return false;
+    }
+
+    // Capacity of the dictionary to train for this configuration, in bytes;
+    // 0 if the compressor compresses every chunk on its own.
+    virtual std::size_t dictionaryCapacity() const {
+        return 0;
+    }
+
+    // Train a dictionary shared by all chunks from sample chunks, and use it for
+    // subsequent compress() and decompress() calls. Returns the dictionary, which
+    // must be stored once alongside the chunks. An empty result (e.g. too little
+    // sample data to train on) means chunks are compressed without one.
+    virtual std::vector<std::uint8_t> trainDictionary(const std::vector<std::vector<float>>& samples) {
+        (void)samples;
+        return {};
+    }
+
+    // Use a dictionary returned by trainDictionary(), e.g. read back from a container.
+    virtual void setDictionary(std::vector<std::uint8_t> dictionary) {
+        if (!dictionary.empty()) {
+            throw std::runtime_error(name() + " does not use dictionaries.");
+        }
+    }
+
     // Parse comma-separated arguments specific to the compressor implementation.
     virtual void configure(const std::map<std::string, std::string>& options) = 0;
 
+    // Create an independent compressor with the same configuration.
+    virtual std::unique_ptr<Compressor> clone() const = 0;
+
     // Return configuration as a map<string, string>
     virtual std::map<std::string, std::string> getConfig() const = 0;
 
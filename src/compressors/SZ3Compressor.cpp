@@ -1,16 +1,57 @@
+#include <algorithm>
+#include <format>
+
 #include "SZ3Compressor.hpp"
 #include <SZ3/api/sz.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+// Sets the number of threads of the calling thread's OpenMP parallel regions
+// while in scope; 0 keeps the current setting.
+class OmpThreadsScope {
+public:
+    explicit OmpThreadsScope(int threads) {
+#ifdef _OPENMP
+        if (threads > 0) {
+            _previous = omp_get_max_threads();
+            omp_set_num_threads(threads);
+        }
+#else
+        (void)threads;
+#endif
+    }
+
+    ~OmpThreadsScope() {
+#ifdef _OPENMP
+        if (_previous > 0) {
+            omp_set_num_threads(_previous);
+        }
+#endif
+    }
+
+    OmpThreadsScope(const OmpThreadsScope&) = delete;
+    OmpThreadsScope& operator=(const OmpThreadsScope&) = delete;
+
+private:
+    int _previous = 0;
+};
+
+} // namespace
 
 CompressedData SZ3Compressor::compress(const std::vector<float>& data) {
     // Use a fresh config per call so SZ3 internal mutations don't persist
     SZ3::Config config = _userConfig;
 
     // Set config dimensions
-    std::vector<size_t> dims = {data.size()};
-    config.setDims(dims.begin(), dims.end());
+    std::vector<size_t> shape = dims(data.size());
+    config.setDims(shape.begin(), shape.end());
 
     // Compress
+    const OmpThreadsScope ompThreads(config.openmp ? _threads : 0);
     size_t compressedSize = 0;
     char* compressedDataBuffer = SZ_compress(
         config,
@@ -35,39 +76,68 @@ CompressedData SZ3Compressor::compress(const std::vector<float>& data) {
 }
 
 std::vector<float> SZ3Compressor::decompress(const CompressedData& compressedData) {
+    return decompressBytes(compressedData.data, compressedData.numFloats);
+}
+
+std::vector<float> SZ3Compressor::decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) {
+    std::vector<float> decompressedData(numFloats);
+    decompressInto(bytes, decompressedData);
+    return decompressedData;
+}
+
+void SZ3Compressor::decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) {
     // Use a fresh config per call so SZ3 internal mutations don't persist
     SZ3::Config config = _userConfig;
 
     // Set config dimensions
-    std::vector<size_t> dims = {compressedData.numFloats};
-    config.setDims(dims.begin(), dims.end());
-
-    // Allocate output buffer
-    float* decompressedDataBuffer = nullptr;
+    std::vector<size_t> shape = dims(output.size());
+    config.setDims(shape.begin(), shape.end());
 
-    // Decompress
+    // Decompress; SZ3 only allocates the output buffer if it is given none
+    float* decompressedDataBuffer = output.data();
+    const OmpThreadsScope ompThreads(config.openmp ? _threads : 0);
     SZ_decompress(
         config,
-        reinterpret_cast<const char*>(compressedData.data.data()),
-        compressedData.data.size(),
+        reinterpret_cast<const char*>(bytes.data()),
+        bytes.size(),
         decompressedDataBuffer
     );
 
-    if (!decompressedDataBuffer) {
+    if (decompressedDataBuffer != output.data()) {
+        free(decompressedDataBuffer);
         throw std::runtime_error("SZ3 decompression failed.");
     }
+}
 
-    // Convert to vector<float>
-    std::vector<float> decompressedData(decompressedDataBuffer, decompressedDataBuffer + compressedData.numFloats);
+std::vector<size_t> SZ3Compressor::dims(std::size_t numFloats) const {
+    std::size_t rowSize = 1;
+    for (std::size_t d : _innerDims) {
+        rowSize *= d;
+    }
+    if (_innerDims.empty() || rowSize == 0 || numFloats % rowSize != 0) {
+        return {numFloats};
+    }
 
-    // Free SZ3 allocated memory
-    free(decompressedDataBuffer);
+    std::vector<size_t> shape = {numFloats / rowSize};
+    shape.insert(shape.end(), _innerDims.begin(), _innerDims.end());
+    return shape;
+}
 
-    return decompressedData;
+bool SZ3Compressor::setThreads(std::size_t threads) {
+    // OpenMP mode compresses blocks independently, which can change the ratio
+    _userConfig.openmp = threads > 1;
+    _threads = static_cast<int>(threads);
+    return true;
+}
+
+void SZ3Compressor::setInnerDims(const std::vector<std::size_t>& innerDims) {
+    _innerDims = innerDims;
 }
 
 void SZ3Compressor::configure(const std::map<std::string, std::string>& options) {
     _userConfig = SZ3::Config();
+    _innerDims.clear();
+    _threads = 0;
 
     for (const auto& [key, value] : options) {
         if (key == "cmprAlgo") {
@@ -116,6 +186,13 @@ void SZ3Compressor::configure(const std::map<std::string, std::string>& options)
             }
         } else if (key == "openmp") {
             _userConfig.openmp = (value == "true" || value == "1");
+        } else if (key == "threads") {
+            _threads = std::stoi(value);
+
+            // Validate
+            if (_threads < 0) {
+                throw std::invalid_argument("Invalid threads value: " + value + ". Must be non-negative.");
+            }
         } else if (key == "quantbinCnt") {
             _userConfig.quantbinCnt = std::stoi(value);
 
@@ -162,22 +239,44 @@ void SZ3Compressor::configure(const std::map<std::string, std::string>& options)
             _userConfig.interpBeta = std::stod(value);
 
             // Uncertain about which values are allowed
+        } else if (key == "innerDims") {
+            // Trailing dimensions as AxB...; "none" for 1D
+            _innerDims.clear();
+            if (value != "none") {
+                std::size_t start = 0;
+                while (start <= value.size()) {
+                    const std::size_t pos = std::min(value.find('x', start), value.size());
+                    _innerDims.push_back(std::stoul(value.substr(start, pos - start)));
+                    start = pos + 1;
+                }
+            }
+
+            // Validate
+            // SZ3 supports up to 4 dimensions
+            if (_innerDims.size() > 3) {
+                throw std::invalid_argument("Invalid innerDims value: " + value + ". At most 3 inner dimensions are supported.");
+            }
         }
     }
 
     // _userConfig is ready for use; per-call copies are created in compress/decompress
 }
 
+std::unique_ptr<Compressor> SZ3Compressor::clone() const {
+    return std::make_unique<SZ3Compressor>(*this);
+}
+
 std::map<std::string, std::string> SZ3Compressor::getConfig() const {
     std::map<std::string, std::string> configMap;
 
     configMap["cmprAlgo"] = std::to_string(_userConfig.cmprAlgo);
     configMap["errorBoundMode"] = std::to_string(_userConfig.errorBoundMode);
-    configMap["absErrorBound"] = std::to_string(_userConfig.absErrorBound);
-    configMap["relErrorBound"] =  std::to_string(_userConfig.relErrorBound);
-    configMap["psnrErrorBound"] = std::to_string(_userConfig.psnrErrorBound);
-    configMap["l2normErrorBound"] = std::to_string(_userConfig.l2normErrorBound);
+    configMap["absErrorBound"] = std::format("{}", _userConfig.absErrorBound);
+    configMap["relErrorBound"] =  std::format("{}", _userConfig.relErrorBound);
+    configMap["psnrErrorBound"] = std::format("{}", _userConfig.psnrErrorBound);
+    configMap["l2normErrorBound"] = std::format("{}", _userConfig.l2normErrorBound);
     configMap["openmp"] = _userConfig.openmp ? "true" : "false";
+    configMap["threads"] = std::to_string(_threads);
     configMap["quantbinCnt"] = std::to_string(_userConfig.quantbinCnt);
     configMap["blockSize"] = std::to_string(_userConfig.blockSize);
     configMap["lorenzo"] = _userConfig.lorenzo ? "true" : "false";
@@ -187,8 +286,14 @@ std::map<std::string, std::string> SZ3Compressor::getConfig() const {
     configMap["interpAlgo"] = std::to_string(_userConfig.interpAlgo);
     configMap["interpDirection"] = std::to_string(_userConfig.interpDirection);
     configMap["interpAnchorStride"] = std::to_string(_userConfig.interpAnchorStride);
-    configMap["interpAlpha"] = std::to_string(_userConfig.interpAlpha);
-    configMap["interpBeta"] = std::to_string(_userConfig.interpBeta);
+    configMap["interpAlpha"] = std::format("{}", _userConfig.interpAlpha);
+    configMap["interpBeta"] = std::format("{}", _userConfig.interpBeta);
+
+    std::string innerDims;
+    for (std::size_t d : _innerDims) {
+        innerDims += (innerDims.empty() ? "" : "x") + std::to_string(d);
+    }
+    configMap["innerDims"] = innerDims.empty() ? "none" : innerDims;
 
     return configMap;
 }
@@ -216,6 +321,7 @@ std::string SZ3Compressor::usage() const {
            "  - psnrErrorBound:   double, Set the PSNR error bound\n"
            "  - l2normErrorBound: double, Set the L2 norm error bound\n"
            "  - openmp:           bool, Enable OpenMP parallelization\n"
+           "  - threads:          int, OpenMP threads when openmp is enabled; 0 uses the OpenMP default\n"
            "  Algorithm-specific options:\n"
            "  - quantbinCnt:    int, Maximum number of quantization intervals\n"
            "  - blockSize:      int, Block size for processing\n"
@@ -227,5 +333,7 @@ std::string SZ3Compressor::usage() const {
            "  - interpDirection:    uint8_t, Set the interpolation direction\n"
            "  - interpAnchorStride: int, Set the interpolation anchor stride\n"
            "  - interpAlpha:        double, Interpolation error-bound tuning parameter\n"
-           "  - interpBeta:         double, Interpolation error-bound tuning parameter";
+           "  - interpBeta:         double, Interpolation error-bound tuning parameter\n"
+           "  Layout options:\n"
+           "  - innerDims:          AxB..., Trailing dimensions of each chunk (e.g. 16 or 16x4), or none for 1D";
 };
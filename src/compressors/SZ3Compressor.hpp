@@ -2,6 +2,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 // #include <cmath>
@@ -13,13 +14,26 @@ class SZ3Compressor : public Compressor {
 public: 
     CompressedData compress(const std::vector<float>& data) override;
     std::vector<float> decompress(const CompressedData& compressedData) override;
+    std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) override;
+    void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) override;
+    bool setThreads(std::size_t threads) override;
+    void setInnerDims(const std::vector<std::size_t>& innerDims) override;
     void configure(const std::map<std::string, std::string>& options) override;
+    std::unique_ptr<Compressor> clone() const override;
     std::map<std::string, std::string> getConfig() const override;
     std::string name() const override;
     std::string description() const override;
     std::string version() const override;
     std::string usage() const override;
 private:
+    // SZ3 dimensions for a buffer of numFloats values, slowest first.
+    // Falls back to 1D when the buffer is not a whole number of rows.
+    std::vector<size_t> dims(std::size_t numFloats) const;
+
     // _userConfig stores user-specified settings; per-call copies are made in compress/decompress
     SZ3::Config _userConfig;
+    // Trailing dimensions of each buffer; empty for 1D
+    std::vector<std::size_t> _innerDims;
+    // OpenMP threads when openmp is enabled; 0 uses the OpenMP default
+    int _threads = 0;
 };
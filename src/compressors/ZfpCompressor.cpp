@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#include <zfp.h>
+
+#include "CompressedOutput.hpp"
+#include "ZfpCompressor.hpp"
+
+namespace {
+
+// Owns the ZFP objects for one compress or decompress call.
+struct ZfpHandles {
+    zfp_field* field = nullptr;
+    zfp_stream* stream = nullptr;
+    bitstream* bits = nullptr;
+
+    ~ZfpHandles() {
+        if (stream) zfp_stream_close(stream);
+        if (bits) stream_close(bits);
+        if (field) zfp_field_free(field);
+    }
+};
+
+zfp_field* makeField(float* data, const std::vector<std::size_t>& shape) {
+    // ZFP takes the fastest-varying extent first
+    switch (shape.size()) {
+        case 1: return zfp_field_1d(data, zfp_type_float, shape[0]);
+        case 2: return zfp_field_2d(data, zfp_type_float, shape[1], shape[0]);
+        case 3: return zfp_field_3d(data, zfp_type_float, shape[2], shape[1], shape[0]);
+    }
+    throw std::runtime_error("ZFP supports 1 to 3 dimensions.");
+}
+
+// Apply the compression mode; decompression must use the same settings.
+void setMode(zfp_stream* stream, const std::string& mode,
+             double rate, unsigned precision, double tolerance, unsigned dims) {
+    if (mode == "rate") {
+        // Aligned fixed-rate blocks allow random access into the stream
+        zfp_stream_set_rate(stream, rate, zfp_type_float, dims, zfp_true);
+    } else if (mode == "precision") {
+        zfp_stream_set_precision(stream, precision);
+    } else if (mode == "accuracy") {
+        zfp_stream_set_accuracy(stream, tolerance);
+    } else {
+        zfp_stream_set_reversible(stream);
+    }
+}
+
+} // namespace
+
+std::vector<std::size_t> ZfpCompressor::shape(std::size_t numFloats) const {
+    switch (_dims) {
+        case 2:
+            return {(numFloats + _nx - 1) / _nx, _nx};
+        case 3:
+            return {(numFloats + _nx * _ny - 1) / (_nx * _ny), _ny, _nx};
+        default:
+            return {numFloats};
+    }
+}
+
+CompressedData ZfpCompressor::compress(const std::vector<float>& data) {
+    return compressViaScratch(*this, data);
+}
+
+std::size_t ZfpCompressor::maxCompressedSize(std::size_t numFloats) const {
+    // The bound depends only on the shape and mode, not on the values
+    const std::vector<std::size_t> dims = shape(numFloats);
+    ZfpHandles zfp;
+    zfp.field = makeField(nullptr, dims);
+    zfp.stream = zfp_stream_open(nullptr);
+    setMode(zfp.stream, _mode, _rate, _precision, _tolerance, static_cast<unsigned>(dims.size()));
+    return zfp_stream_maximum_size(zfp.stream, zfp.field);
+}
+
+std::size_t ZfpCompressor::compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) {
+    // Pad the slowest dimension by repeating the last value, which keeps the
+    // padded blocks cheap to encode
+    const std::vector<std::size_t> dims = shape(data.size());
+    std::size_t paddedSize = 1;
+    for (std::size_t d : dims) {
+        paddedSize *= d;
+    }
+    PooledBuffer padded;
+    const float* input = data.data();
+    if (paddedSize != data.size()) {
+        padded = BufferPool::global().acquire(paddedSize * sizeof(float));
+        auto* values = reinterpret_cast<float*>(padded.data());
+        std::copy(data.begin(), data.end(), values);
+        std::fill(values + data.size(), values + paddedSize, data.empty() ? 0.0f : data.back());
+        input = values;
+    }
+
+    ZfpHandles zfp;
+    zfp.field = makeField(const_cast<float*>(input), dims);
+    zfp.stream = zfp_stream_open(nullptr);
+
+    setMode(zfp.stream, _mode, _rate, _precision, _tolerance, static_cast<unsigned>(dims.size()));
+
+    if (_execution == "omp") {
+        if (!zfp_stream_set_execution(zfp.stream, zfp_exec_omp)) {
+            throw std::runtime_error("ZFP was built without OpenMP support.");
+        }
+        if (_threads > 0) {
+            zfp_stream_set_omp_threads(zfp.stream, _threads);
+        }
+    }
+
+    // Compress; ZFP does not check the bounds of its output as it writes
+    if (output.size() < zfp_stream_maximum_size(zfp.stream, zfp.field)) {
+        throw std::length_error("ZFP output buffer is smaller than maxCompressedSize().");
+    }
+    zfp.bits = stream_open(output.data(), output.size());
+    zfp_stream_set_bit_stream(zfp.stream, zfp.bits);
+    zfp_stream_rewind(zfp.stream);
+
+    const std::size_t compressedSize = zfp_compress(zfp.stream, zfp.field);
+    if (compressedSize == 0) {
+        throw std::runtime_error("ZFP compression failed.");
+    }
+    return compressedSize;
+}
+
+std::vector<float> ZfpCompressor::decompress(const CompressedData& compressedData) {
+    return decompressBytes(compressedData.data, compressedData.numFloats);
+}
+
+std::vector<float> ZfpCompressor::decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) {
+    std::vector<float> decompressedData(numFloats);
+    decompressInto(bytes, decompressedData);
+    return decompressedData;
+}
+
+void ZfpCompressor::decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) {
+    const std::vector<std::size_t> dims = shape(output.size());
+    std::size_t paddedSize = 1;
+    for (std::size_t d : dims) {
+        paddedSize *= d;
+    }
+
+    // Decompress in place unless the array was padded
+    PooledBuffer padded;
+    float* target = output.data();
+    if (paddedSize != output.size()) {
+        padded = BufferPool::global().acquire(paddedSize * sizeof(float));
+        target = reinterpret_cast<float*>(padded.data());
+    }
+
+    ZfpHandles zfp;
+    zfp.field = makeField(target, dims);
+    zfp.stream = zfp_stream_open(nullptr);
+
+    setMode(zfp.stream, _mode, _rate, _precision, _tolerance, static_cast<unsigned>(dims.size()));
+
+    // ZFP only decompresses serially; the OpenMP policy applies to compression
+
+    // Decompress
+    zfp.bits = stream_open(const_cast<std::uint8_t*>(bytes.data()), bytes.size());
+    zfp_stream_set_bit_stream(zfp.stream, zfp.bits);
+    zfp_stream_rewind(zfp.stream);
+
+    if (zfp_decompress(zfp.stream, zfp.field) == 0) {
+        throw std::runtime_error("ZFP decompression failed.");
+    }
+
+    // Drop padding
+    if (target != output.data()) {
+        std::copy(target, target + output.size(), output.begin());
+    }
+}
+
+bool ZfpCompressor::setThreads(std::size_t threads) {
+    // Only compression is parallel; ZFP decompresses serially
+    _execution = threads > 1 ? "omp" : "serial";
+    _threads = static_cast<unsigned>(threads);
+    return true;
+}
+
+void ZfpCompressor::configure(const std::map<std::string, std::string>& options) {
+    for (const auto& [key, value] : options) {
+        if (key == "mode") {
+            _mode = value;
+
+            // Validate
+            if (_mode != "rate" && _mode != "precision" && _mode != "accuracy" && _mode != "reversible") {
+                throw std::invalid_argument("Invalid ZFP mode: " + value + ". Must be rate, precision, accuracy or reversible.");
+            }
+        } else if (key == "rate") {
+            _rate = std::stod(value);
+
+            // Validate
+            if (_rate <= 0.0 || _rate > 32.0) {
+                throw std::invalid_argument("Invalid ZFP rate: " + value + ". Must be in (0, 32].");
+            }
+        } else if (key == "precision") {
+            _precision = static_cast<unsigned>(std::stoul(value));
+
+            // Validate
+            if (_precision < 1 || _precision > 32) {
+                throw std::invalid_argument("Invalid ZFP precision: " + value + ". Must be between 1 and 32.");
+            }
+        } else if (key == "tolerance") {
+            _tolerance = std::stod(value);
+
+            // Validate
+            if (_tolerance < 0.0) {
+                throw std::invalid_argument("Invalid ZFP tolerance: " + value + ". Must be non-negative.");
+            }
+        } else if (key == "execution") {
+            _execution = value;
+
+            // Validate
+            if (_execution != "serial" && _execution != "omp") {
+                throw std::invalid_argument("Invalid ZFP execution policy: " + value + ". Must be serial or omp.");
+            }
+        } else if (key == "threads") {
+            _threads = static_cast<unsigned>(std::stoul(value));
+        } else if (key == "dims") {
+            _dims = static_cast<unsigned>(std::stoul(value));
+
+            // Validate
+            if (_dims < 1 || _dims > 3) {
+                throw std::invalid_argument("Invalid ZFP dims: " + value + ". Must be between 1 and 3.");
+            }
+        } else if (key == "nx") {
+            _nx = std::stoul(value);
+        } else if (key == "ny") {
+            _ny = std::stoul(value);
+        }
+    }
+
+    // Inner extents must be known for multi-dimensional layouts
+    if ((_dims >= 2 && _nx == 0) || (_dims == 3 && _ny == 0)) {
+        throw std::invalid_argument("ZFP dims=2 requires nx, and dims=3 requires nx and ny.");
+    }
+}
+
+std::unique_ptr<Compressor> ZfpCompressor::clone() const {
+    return std::make_unique<ZfpCompressor>(*this);
+}
+
+std::map<std::string, std::string> ZfpCompressor::getConfig() const {
+    return {
+        {"mode", _mode},
+        {"rate", std::format("{}", _rate)},
+        {"precision", std::to_string(_precision)},
+        {"tolerance", std::format("{}", _tolerance)},
+        {"execution", _execution},
+        {"threads", std::to_string(_threads)},
+        {"dims", std::to_string(_dims)},
+        {"nx", std::to_string(_nx)},
+        {"ny", std::to_string(_ny)}
+    };
+}
+
+std::string ZfpCompressor::name() const {
+    return "zfp";
+}
+
+std::string ZfpCompressor::description() const {
+    return "Lossy and lossless compression of floating-point arrays using ZFP.";
+}
+
+std::string ZfpCompressor::version() const {
+    return std::format("zfp {}", ZFP_VERSION_STRING);
+}
+
+std::string ZfpCompressor::usage() const {
+    return "Options:\n"
+           "  mode=<rate|precision|accuracy|reversible>  Compression mode. Default is accuracy.\n"
+           "  rate=<double>        Bits per value in fixed-rate mode. Default is 8.\n"
+           "                       Fixed-rate streams are block aligned and support random access.\n"
+           "  precision=<uint>     Bit planes kept in fixed-precision mode (1-32). Default is 16.\n"
+           "  tolerance=<double>   Absolute error tolerance in fixed-accuracy mode. Default is 1e-3.\n"
+           "  execution=<serial|omp>  Execution policy for compression. Default is serial.\n"
+           "  threads=<uint>       OpenMP threads when execution=omp; 0 uses the OpenMP default.\n"
+           "  dims=<1|2|3>         Dimensionality of the array handed to ZFP. Default is 1.\n"
+           "  nx=<uint>            Fastest-varying extent for dims=2 and dims=3.\n"
+           "  ny=<uint>            Middle extent for dims=3.\n"
+           "                       The slowest extent is derived from the chunk size and padded.";
+}
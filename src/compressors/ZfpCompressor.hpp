@@ -0,0 +1,41 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Compressor.hpp"
+
+class ZfpCompressor : public Compressor {
+public:
+    CompressedData compress(const std::vector<float>& data) override;
+    std::size_t maxCompressedSize(std::size_t numFloats) const override;
+    std::size_t compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) override;
+    std::vector<float> decompress(const CompressedData& compressedData) override;
+    std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) override;
+    void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) override;
+    bool setThreads(std::size_t threads) override;
+    void configure(const std::map<std::string, std::string>& options) override;
+    std::unique_ptr<Compressor> clone() const override;
+    std::map<std::string, std::string> getConfig() const override;
+    std::string name() const override;
+    std::string description() const override;
+    std::string version() const override;
+    std::string usage() const override;
+
+private:
+    // Array shape used for a buffer of numFloats values, slowest dimension first.
+    // The slowest dimension is rounded up, so the shape may hold a few padding values.
+    std::vector<std::size_t> shape(std::size_t numFloats) const;
+
+    std::string _mode = "accuracy";  // rate, precision, accuracy or reversible
+    double _rate = 8.0;              // Bits per value in fixed-rate mode
+    unsigned _precision = 16;        // Uncompressed bit planes in fixed-precision mode
+    double _tolerance = 1e-3;        // Absolute error tolerance in fixed-accuracy mode
+    std::string _execution = "serial"; // serial or omp
+    unsigned _threads = 0;           // OpenMP threads; 0 uses the OpenMP default
+    unsigned _dims = 1;              // Dimensionality of the array handed to ZFP (1-3)
+    std::size_t _nx = 0;             // Fastest-varying extent for 2D/3D
+    std::size_t _ny = 0;             // Middle extent for 3D
+};
@@ -1,77 +1,100 @@
 #include <format>
+#include <stdexcept>
 
 #include <zlib.h>
 
+#include "codecs.hpp"
+#include "CompressedOutput.hpp"
+#include "dictionary.hpp"
 #include "ZlibCompressor.hpp"
 
+namespace {
+
+// zlib only references the last 32 KB of a preset dictionary
+constexpr std::size_t kMaxDictSize = 32 * 1024;
+
+} // namespace
+
 CompressedData ZlibCompressor::compress(const std::vector<float>& data) {
-    // Setup
-    const uint8_t* inputBytes = reinterpret_cast<const uint8_t*>(data.data());
-    const uLongf inputSize = static_cast<uLongf>(data.size() * sizeof(float));
-    uLongf maxCompressedSize = compressBound(inputSize);
-    std::vector<std::uint8_t> compressedData(maxCompressedSize);
-
-    // Compress
-    int res = compress2(
-        compressedData.data(),
-        &maxCompressedSize,
-        inputBytes,
-        inputSize,
-        _compressionLevel
-    );
-
-    // Error checking
-    if (res != Z_OK) {
-        throw std::runtime_error("Zlib compression failed with error code: " + std::to_string(res));
-    }
+    return compressViaScratch(*this, data);
+}
 
-    // Return resized buffer
-    compressedData.resize(maxCompressedSize);
-    return {
-        .data = std::move(compressedData),
-        .numFloats = data.size()
-    };
+std::size_t ZlibCompressor::maxCompressedSize(std::size_t numFloats) const {
+    // deflateBound() of a default stream: compressBound() only covers
+    // compress2(), and a preset dictionary adds its 4-byte ID to the header
+    return compressBound(static_cast<uLong>(numFloats * sizeof(float))) + (_dictionary.empty() ? 0 : 4);
+}
+
+std::size_t ZlibCompressor::compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) {
+    const std::span<const std::uint8_t> input(
+        reinterpret_cast<const std::uint8_t*>(data.data()), data.size() * sizeof(float));
+    return zlibCompress(input, output, _compressionLevel, _dictionary);
 }
 
 std::vector<float> ZlibCompressor::decompress(const CompressedData& compressedData) {
-    const std::size_t floatCount = compressedData.numFloats;
-    uLongf outputBytes = static_cast<uLongf>(floatCount * sizeof(float));
-    std::vector<float> decompressedData(floatCount);
-
-    // Decompress
-    int res = uncompress(
-        reinterpret_cast<Bytef*>(decompressedData.data()),
-        // uncompress will set this to the actual output byte size; initialize with expected
-        &outputBytes,
-        compressedData.data.data(),
-        static_cast<uLongf>(compressedData.data.size())
-    );
-
-    // Error checking
-    if (res != Z_OK) {
-        throw std::runtime_error("Zlib decompression failed with error code: " + std::to_string(res));
-    }
+    return decompressBytes(compressedData.data, compressedData.numFloats);
+}
 
-    // Return decompressed data
+std::vector<float> ZlibCompressor::decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) {
+    std::vector<float> decompressedData(numFloats);
+    decompressInto(bytes, decompressedData);
     return decompressedData;
 }
 
+void ZlibCompressor::decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) {
+    zlibDecompress(
+        bytes,
+        std::span<std::uint8_t>(reinterpret_cast<std::uint8_t*>(output.data()), output.size_bytes()),
+        _dictionary);
+}
+
+std::size_t ZlibCompressor::dictionaryCapacity() const {
+    return _dictSize;
+}
+
+std::vector<std::uint8_t> ZlibCompressor::trainDictionary(const std::vector<std::vector<float>>& samples) {
+    // zlib takes raw bytes, so only the content of a trained zstd dictionary is used
+    std::vector<std::uint8_t> dictionary{trainZstdDictionary(samples, _dictSize)};
+    setDictionary(dictionary.empty() ? dictionary : dictionaryContent(dictionary));
+    return _dictionary;
+}
+
+void ZlibCompressor::setDictionary(std::vector<std::uint8_t> dictionary) {
+    _dictionary = std::move(dictionary);
+}
+
 void ZlibCompressor::configure(const std::map<std::string, std::string>& options) {
     for (const auto& option : options) {
         if (option.first == "compressionLevel") {
-            _compressionLevel = std::stoi(option.second);
+            _compressionLevel = parseZlibLevel(option.second);
+        } else if (option.first == "dictSize") {
+            const std::size_t dictSize = std::stoul(option.second);
 
             // Validate
-            if (_compressionLevel < 0 || _compressionLevel > 9) {
-                throw std::runtime_error("Invalid compression level for zlib. Must be between 0 and 9.");
+            if (dictSize != 0 && dictSize < kMinDictionarySize) {
+                throw std::runtime_error("Invalid dictSize for zlib. Must be 0 or at least 256 (the zstd trainer's minimum).");
+            }
+            if (dictSize > kMaxDictSize) {
+                throw std::runtime_error("Invalid dictSize for zlib. Must be at most 32768 (the zlib window).");
+            }
+
+            // A dictionary trained for another capacity no longer applies
+            if (dictSize != _dictSize) {
+                _dictionary.clear();
             }
+            _dictSize = dictSize;
         }
     }
 }
 
+std::unique_ptr<Compressor> ZlibCompressor::clone() const {
+    return std::make_unique<ZlibCompressor>(*this);
+}
+
 std::map<std::string, std::string> ZlibCompressor::getConfig() const {
     return {
-        {"compressionLevel", std::to_string(_compressionLevel)}
+        {"compressionLevel", std::to_string(_compressionLevel)},
+        {"dictSize", std::to_string(_dictSize)}
     };
 }
 
@@ -89,5 +112,9 @@ std::string ZlibCompressor::version() const {
 
 std::string ZlibCompressor::usage() const {
     return "Options:\n"
-           "  compressionLevel=<int>  Set the zlib compression level (0-9). Default is 6.";
+           "  compressionLevel=<int>  Set the zlib compression level (0-9). Default is 6.\n"
+           "  dictSize=<bytes>        Train a preset dictionary of up to this size (at most 32768)\n"
+           "                          from a sample of each branch's chunks and use it for every\n"
+           "                          chunk. Its size counts toward the compressed size. Default\n"
+           "                          is 0 (no dictionary).";
 }
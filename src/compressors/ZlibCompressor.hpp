@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -9,8 +11,16 @@
 class ZlibCompressor : public Compressor {
 public:
     CompressedData compress(const std::vector<float>& data) override;
+    std::size_t maxCompressedSize(std::size_t numFloats) const override;
+    std::size_t compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) override;
     std::vector<float> decompress(const CompressedData& compressedData) override;
+    std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) override;
+    void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) override;
+    std::size_t dictionaryCapacity() const override;
+    std::vector<std::uint8_t> trainDictionary(const std::vector<std::vector<float>>& samples) override;
+    void setDictionary(std::vector<std::uint8_t> dictionary) override;
     void configure(const std::map<std::string, std::string>& options) override;
+    std::unique_ptr<Compressor> clone() const override;
     std::map<std::string, std::string> getConfig() const override;
     std::string name() const override;
     std::string description() const override;
@@ -19,4 +29,6 @@ public:
 
 private:
     int _compressionLevel = 6; // Default zlib compression level
+    std::size_t _dictSize = 0;  // Preset dictionary capacity in bytes; 0 disables it
+    std::vector<std::uint8_t> _dictionary;
 };
@@ -0,0 +1,132 @@
+#include <format>
+#include <stdexcept>
+
+#include <zstd.h>
+
+#include "CompressedOutput.hpp"
+#include "dictionary.hpp"
+#include "ZstdCompressor.hpp"
+
+CompressedData ZstdCompressor::compress(const std::vector<float>& data) {
+    return compressViaScratch(*this, data);
+}
+
+std::size_t ZstdCompressor::maxCompressedSize(std::size_t numFloats) const {
+    return ZSTD_compressBound(numFloats * sizeof(float));
+}
+
+std::size_t ZstdCompressor::compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) {
+    const std::span<const std::uint8_t> input(
+        reinterpret_cast<const std::uint8_t*>(data.data()), data.size() * sizeof(float));
+
+    // Compress, with the shared dictionary if one has been trained
+    return _contexts.compress(input, output, _compressionLevel, _cdict.get());
+}
+
+std::vector<float> ZstdCompressor::decompress(const CompressedData& compressedData) {
+    return decompressBytes(compressedData.data, compressedData.numFloats);
+}
+
+std::vector<float> ZstdCompressor::decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) {
+    std::vector<float> decompressedData(numFloats);
+    decompressInto(bytes, decompressedData);
+    return decompressedData;
+}
+
+void ZstdCompressor::decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) {
+    _contexts.decompress(
+        bytes,
+        std::span<std::uint8_t>(reinterpret_cast<std::uint8_t*>(output.data()), output.size_bytes()),
+        _ddict.get());
+}
+
+std::size_t ZstdCompressor::dictionaryCapacity() const {
+    return _dictSize;
+}
+
+std::vector<std::uint8_t> ZstdCompressor::trainDictionary(const std::vector<std::vector<float>>& samples) {
+    setDictionary(trainZstdDictionary(samples, _dictSize));
+    return _dictionary;
+}
+
+void ZstdCompressor::setDictionary(std::vector<std::uint8_t> dictionary) {
+    _dictionary = std::move(dictionary);
+    loadDictionary();
+}
+
+void ZstdCompressor::loadDictionary() {
+    if (_dictionary.empty()) {
+        _cdict.reset();
+        _ddict.reset();
+        return;
+    }
+
+    _cdict = std::shared_ptr<const ZSTD_CDict_s>(
+        ZSTD_createCDict(_dictionary.data(), _dictionary.size(), _compressionLevel),
+        [](const ZSTD_CDict_s* cdict) { ZSTD_freeCDict(const_cast<ZSTD_CDict_s*>(cdict)); });
+    _ddict = std::shared_ptr<const ZSTD_DDict_s>(
+        ZSTD_createDDict(_dictionary.data(), _dictionary.size()),
+        [](const ZSTD_DDict_s* ddict) { ZSTD_freeDDict(const_cast<ZSTD_DDict_s*>(ddict)); });
+    if (!_cdict || !_ddict) {
+        throw std::runtime_error("Failed to load zstd dictionary.");
+    }
+}
+
+void ZstdCompressor::configure(const std::map<std::string, std::string>& options) {
+    for (const auto& [key, value] : options) {
+        if (key == "compressionLevel") {
+            _compressionLevel = parseZstdLevel(value);
+        } else if (key == "dictSize") {
+            const std::size_t dictSize = std::stoul(value);
+
+            // Validate
+            if (dictSize != 0 && (dictSize < kMinDictionarySize || dictSize > kMaxDictionarySize)) {
+                throw std::invalid_argument(std::format(
+                    "Invalid zstd dictSize: {}. Must be 0 or between {} and {}.",
+                    value, kMinDictionarySize, kMaxDictionarySize));
+            }
+
+            // A dictionary trained for another capacity no longer applies
+            if (dictSize != _dictSize) {
+                _dictionary.clear();
+            }
+            _dictSize = dictSize;
+        }
+    }
+
+    // The digested dictionary depends on the compression level
+    loadDictionary();
+}
+
+std::unique_ptr<Compressor> ZstdCompressor::clone() const {
+    // The copy gets fresh contexts; the digested dictionaries are read-only and shared
+    return std::make_unique<ZstdCompressor>(*this);
+}
+
+std::map<std::string, std::string> ZstdCompressor::getConfig() const {
+    return {
+        {"compressionLevel", std::to_string(_compressionLevel)},
+        {"dictSize", std::to_string(_dictSize)}
+    };
+}
+
+std::string ZstdCompressor::name() const {
+    return "zstd";
+}
+
+std::string ZstdCompressor::description() const {
+    return "Lossless compressor using zstd, optionally with a dictionary trained per branch.";
+}
+
+std::string ZstdCompressor::version() const {
+    return std::format("zstd {}", ZSTD_versionString());
+}
+
+std::string ZstdCompressor::usage() const {
+    return "Options:\n"
+           "  compressionLevel=<int>  Set the zstd compression level. Default is 3.\n"
+           "  dictSize=<bytes>        Train a dictionary of up to this size from a sample of each\n"
+           "                          branch's chunks and use it for every chunk. Its size counts\n"
+           "                          toward the compressed size. 0 (no dictionary, the default) or\n"
+           "                          256 to 1048576.";
+}
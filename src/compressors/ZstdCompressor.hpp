@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "codecs.hpp"
+#include "Compressor.hpp"
+
+class ZstdCompressor : public Compressor {
+public:
+    CompressedData compress(const std::vector<float>& data) override;
+    std::size_t maxCompressedSize(std::size_t numFloats) const override;
+    std::size_t compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) override;
+    std::vector<float> decompress(const CompressedData& compressedData) override;
+    std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) override;
+    void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) override;
+    std::size_t dictionaryCapacity() const override;
+    std::vector<std::uint8_t> trainDictionary(const std::vector<std::vector<float>>& samples) override;
+    void setDictionary(std::vector<std::uint8_t> dictionary) override;
+    void configure(const std::map<std::string, std::string>& options) override;
+    std::unique_ptr<Compressor> clone() const override;
+    std::map<std::string, std::string> getConfig() const override;
+    std::string name() const override;
+    std::string description() const override;
+    std::string version() const override;
+    std::string usage() const override;
+
+private:
+    // (Re)digest the dictionary for the current compression level.
+    void loadDictionary();
+
+    int _compressionLevel = 3;       // Default zstd compression level
+    std::size_t _dictSize = 0;       // Dictionary capacity in bytes; 0 disables it
+
+    // Contexts are reused across chunks; digested dictionaries are read-only
+    // and shared between clones
+    ZstdContexts _contexts;
+    std::vector<std::uint8_t> _dictionary;
+    std::shared_ptr<const ZSTD_CDict_s> _cdict;
+    std::shared_ptr<const ZSTD_DDict_s> _ddict;
+};
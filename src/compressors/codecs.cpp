@@ -0,0 +1,158 @@
+#include <format>
+#include <stdexcept>
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include "codecs.hpp"
+
+ZstdContexts::ZstdContexts()
+    : _cctx(ZSTD_createCCtx(), ZSTD_freeCCtx), _dctx(ZSTD_createDCtx(), ZSTD_freeDCtx)
+{
+    if (!_cctx || !_dctx) {
+        throw std::runtime_error("Failed to create zstd contexts.");
+    }
+}
+
+ZstdContexts::ZstdContexts(const ZstdContexts&) : ZstdContexts() {}
+
+std::size_t ZstdContexts::compress(
+    std::span<const std::uint8_t> in,
+    std::span<std::uint8_t> out,
+    int level,
+    const ZSTD_CDict_s* cdict
+)
+{
+    const std::size_t res = cdict
+        ? ZSTD_compress_usingCDict(_cctx.get(), out.data(), out.size(), in.data(), in.size(), cdict)
+        : ZSTD_compressCCtx(_cctx.get(), out.data(), out.size(), in.data(), in.size(), level);
+
+    // Error checking
+    if (ZSTD_isError(res)) {
+        throw std::runtime_error(std::string("Zstd compression failed: ") + ZSTD_getErrorName(res));
+    }
+    return res;
+}
+
+void ZstdContexts::decompress(
+    std::span<const std::uint8_t> in,
+    std::span<std::uint8_t> out,
+    const ZSTD_DDict_s* ddict
+)
+{
+    const std::size_t res = ddict
+        ? ZSTD_decompress_usingDDict(_dctx.get(), out.data(), out.size(), in.data(), in.size(), ddict)
+        : ZSTD_decompressDCtx(_dctx.get(), out.data(), out.size(), in.data(), in.size());
+
+    // Error checking
+    if (ZSTD_isError(res)) {
+        throw std::runtime_error(std::string("Zstd decompression failed: ") + ZSTD_getErrorName(res));
+    }
+    if (res != out.size()) {
+        throw std::runtime_error("Zstd decompression returned an unexpected size.");
+    }
+}
+
+int parseZstdLevel(const std::string& value) {
+    const int level = std::stoi(value);
+
+    // Validate
+    if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) {
+        throw std::invalid_argument(std::format(
+            "Invalid zstd compression level: {}. Must be between {} and {}.",
+            value, ZSTD_minCLevel(), ZSTD_maxCLevel()));
+    }
+    return level;
+}
+
+int parseZlibLevel(const std::string& value) {
+    const int level = std::stoi(value);
+
+    // Validate
+    if (level < 0 || level > 9) {
+        throw std::invalid_argument("Invalid zlib compression level: " + value + ". Must be between 0 and 9.");
+    }
+    return level;
+}
+
+std::size_t zlibCompress(
+    std::span<const std::uint8_t> in,
+    std::span<std::uint8_t> out,
+    int level,
+    std::span<const std::uint8_t> dictionary
+)
+{
+    // With a preset dictionary the one-shot compress2() cannot be used
+    int res = Z_OK;
+    uLongf compressedSize = static_cast<uLongf>(out.size());
+    if (dictionary.empty()) {
+        res = compress2(out.data(), &compressedSize, in.data(), static_cast<uLong>(in.size()), level);
+    } else {
+        z_stream stream{};
+        res = deflateInit(&stream, level);
+        if (res == Z_OK) {
+            res = deflateSetDictionary(&stream, dictionary.data(), static_cast<uInt>(dictionary.size()));
+        }
+        if (res == Z_OK) {
+            stream.next_in = const_cast<Bytef*>(in.data());
+            stream.avail_in = static_cast<uInt>(in.size());
+            stream.next_out = out.data();
+            stream.avail_out = static_cast<uInt>(out.size());
+            res = deflate(&stream, Z_FINISH) == Z_STREAM_END ? Z_OK : Z_BUF_ERROR;
+            compressedSize = stream.total_out;
+        }
+        deflateEnd(&stream);
+    }
+
+    // Error checking
+    if (res != Z_OK) {
+        throw std::runtime_error("Zlib compression failed with error code: " + std::to_string(res));
+    }
+    return compressedSize;
+}
+
+void zlibDecompress(
+    std::span<const std::uint8_t> in,
+    std::span<std::uint8_t> out,
+    std::span<const std::uint8_t> dictionary
+)
+{
+    // uncompress() sets this to the actual output byte size
+    uLongf outputBytes = static_cast<uLongf>(out.size());
+
+    // Streams written with a preset dictionary ask for it once their header
+    // has been read
+    int res = Z_OK;
+    if (dictionary.empty()) {
+        res = uncompress(out.data(), &outputBytes, in.data(), static_cast<uLong>(in.size()));
+    } else {
+        z_stream stream{};
+        res = inflateInit(&stream);
+        if (res == Z_OK) {
+            stream.next_in = const_cast<Bytef*>(in.data());
+            stream.avail_in = static_cast<uInt>(in.size());
+            stream.next_out = out.data();
+            stream.avail_out = static_cast<uInt>(out.size());
+            res = inflate(&stream, Z_FINISH);
+            if (res == Z_NEED_DICT) {
+                res = inflateSetDictionary(&stream, dictionary.data(), static_cast<uInt>(dictionary.size()));
+                if (res == Z_OK) {
+                    res = inflate(&stream, Z_FINISH);
+                }
+            }
+            if (res == Z_STREAM_END) {
+                res = Z_OK;
+                outputBytes = stream.total_out;
+            }
+        }
+        inflateEnd(&stream);
+    }
+
+    // Error checking
+    if (res != Z_OK) {
+        throw std::runtime_error("Zlib decompression failed with error code: " + std::to_string(res));
+    }
+    if (outputBytes != out.size()) {
+        throw std::runtime_error("Zlib decompression returned an unexpected size.");
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+// zstd and zlib calls shared by ZstdCompressor and ZlibCompressor and by the
+// pipeline codecs (see pipeline.hpp), so that their context setup, option
+// validation and error handling cannot drift apart. Errors are thrown as
+// std::runtime_error, invalid options as std::invalid_argument.
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+// zstd compression and decompression contexts, reused across chunks. A copy
+// gets fresh contexts, since contexts cannot be shared.
+class ZstdContexts {
+public:
+    ZstdContexts();
+    ZstdContexts(const ZstdContexts& other);
+    ZstdContexts& operator=(const ZstdContexts&) = delete;
+
+    // Compress in into out at level, or with cdict if it is not null.
+    // Returns the number of bytes written.
+    std::size_t compress(
+        std::span<const std::uint8_t> in,
+        std::span<std::uint8_t> out,
+        int level,
+        const ZSTD_CDict_s* cdict = nullptr);
+
+    // Decompress in, which must fill out exactly, with ddict if it is not null.
+    void decompress(
+        std::span<const std::uint8_t> in,
+        std::span<std::uint8_t> out,
+        const ZSTD_DDict_s* ddict = nullptr);
+
+private:
+    std::unique_ptr<ZSTD_CCtx_s, std::size_t (*)(ZSTD_CCtx_s*)> _cctx;
+    std::unique_ptr<ZSTD_DCtx_s, std::size_t (*)(ZSTD_DCtx_s*)> _dctx;
+};
+
+// Parse a zstd compression level, between ZSTD_minCLevel() and ZSTD_maxCLevel().
+int parseZstdLevel(const std::string& value);
+
+// Parse a zlib compression level, 0 to 9.
+int parseZlibLevel(const std::string& value);
+
+// Compress in into out at level, with compress2(), or with a deflate stream if
+// a preset dictionary is given. Returns the number of bytes written.
+std::size_t zlibCompress(
+    std::span<const std::uint8_t> in,
+    std::span<std::uint8_t> out,
+    int level,
+    std::span<const std::uint8_t> dictionary = {});
+
+// Decompress in, which must fill out exactly, with the preset dictionary it
+// was compressed with, if any.
+void zlibDecompress(
+    std::span<const std::uint8_t> in,
+    std::span<std::uint8_t> out,
+    std::span<const std::uint8_t> dictionary = {});
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <zdict.h>
+
+#include "dictionary.hpp"
+
+namespace {
+
+// The trainer looks for segments repeated across samples, so long chunks are
+// split into several samples
+constexpr std::size_t kMaxSampleBytes = 16 * 1024;
+
+} // namespace
+
+std::vector<std::uint8_t> trainZstdDictionary(
+    const std::vector<std::vector<float>>& samples,
+    std::size_t capacity
+)
+{
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::size_t> sampleSizes;
+    for (const auto& sample : samples) {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(sample.data());
+        const std::size_t size = sample.size() * sizeof(float);
+        for (std::size_t offset = 0; offset < size; offset += kMaxSampleBytes) {
+            const std::size_t pieceSize = std::min(kMaxSampleBytes, size - offset);
+            buffer.insert(buffer.end(), bytes + offset, bytes + offset + pieceSize);
+            sampleSizes.push_back(pieceSize);
+        }
+    }
+    if (capacity == 0 || sampleSizes.empty()) {
+        return {};
+    }
+
+    std::vector<std::uint8_t> dictionary(capacity);
+    const std::size_t res = ZDICT_trainFromBuffer(
+        dictionary.data(),
+        dictionary.size(),
+        buffer.data(),
+        sampleSizes.data(),
+        static_cast<unsigned>(sampleSizes.size())
+    );
+    if (ZDICT_isError(res)) {
+        return {};
+    }
+    dictionary.resize(res);
+    return dictionary;
+}
+
+std::vector<std::uint8_t> dictionaryContent(const std::vector<std::uint8_t>& dictionary) {
+    const std::size_t headerSize = ZDICT_getDictHeaderSize(dictionary.data(), dictionary.size());
+    if (ZDICT_isError(headerSize)) {
+        throw std::runtime_error(std::string("Invalid zstd dictionary: ") + ZDICT_getErrorName(headerSize));
+    }
+    return {dictionary.begin() + headerSize, dictionary.end()};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Smallest dictionary zstd's trainer produces (ZDICT_DICTSIZE_MIN)
+constexpr std::size_t kMinDictionarySize = 256;
+
+// Largest dictionary capacity accepted; training wants about 100 times as many
+// sample bytes, so larger ones are not useful per branch
+constexpr std::size_t kMaxDictionarySize = 1024 * 1024;
+
+// Train a zstd dictionary of at most capacity bytes from sample chunks with
+// zstd's default trainer (ZDICT_trainFromBuffer). Returns an empty vector if
+// the samples are too small or too uniform to train on.
+std::vector<std::uint8_t> trainZstdDictionary(
+    const std::vector<std::vector<float>>& samples,
+    std::size_t capacity);
+
+// The content of a zstd dictionary without its header (magic, ID and entropy
+// tables), for use as a raw preset dictionary, e.g. by zlib.
+std::vector<std::uint8_t> dictionaryContent(const std::vector<std::uint8_t>& dictionary);
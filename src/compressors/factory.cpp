@@ -1,24 +1,52 @@
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "ZlibCompressor.hpp"
+#include "ZstdCompressor.hpp"
 #include "SZ3Compressor.hpp"
+#include "ZfpCompressor.hpp"
+#include "Blosc2Compressor.hpp"
 #include "factory.hpp"
+#include "pipeline.hpp"
 
 using CompressorFactory = std::unique_ptr<Compressor>(*)();
 
-std::unique_ptr<Compressor> createCompressor(const std::string& name) {
-    static const std::unordered_map<std::string, CompressorFactory> kFactories = {
-        {"zlib", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<ZlibCompressor>(); }},
-        {"sz3", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<SZ3Compressor>(); }},
-    };
+static const std::unordered_map<std::string, CompressorFactory>& factories() {
+    static const std::unordered_map<std::string, CompressorFactory> kFactories = [] {
+        std::unordered_map<std::string, CompressorFactory> factories = {
+            {"zlib", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<ZlibCompressor>(); }},
+            {"zstd", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<ZstdCompressor>(); }},
+            {"sz3", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<SZ3Compressor>(); }},
+            {"zfp", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<ZfpCompressor>(); }},
+            {"blosc2", +[]() -> std::unique_ptr<Compressor> { return std::make_unique<Blosc2Compressor>(); }},
+        };
+        // Statically composed pipelines, e.g. "trunc+shuffle+zstd"
+        for (const auto& [name, factory] : pipelineFactories()) {
+            factories.emplace(name, factory);
+        }
+        return factories;
+    }();
+    return kFactories;
+}
 
-    const auto it = kFactories.find(name);
-    if (it != kFactories.end()) {
+std::unique_ptr<Compressor> createCompressor(const std::string& name) {
+    const auto it = factories().find(name);
+    if (it != factories().end()) {
         return it->second();
     }
 
     throw std::invalid_argument("Unknown compressor: " + name);
 }
+
+std::vector<std::string> listCompressors() {
+    std::vector<std::string> names;
+    for (const auto& [name, factory] : factories()) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
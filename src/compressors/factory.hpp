@@ -2,9 +2,13 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Compressor.hpp"
 
 // Create a compressor instance by name (e.g., "zlib").
 // Throws std::invalid_argument if the name is unknown.
 std::unique_ptr<Compressor> createCompressor(const std::string& name);
+
+// Names of all registered compressors, sorted.
+std::vector<std::string> listCompressors();
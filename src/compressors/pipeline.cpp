@@ -0,0 +1,116 @@
+#include <format>
+#include <stdexcept>
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include "pipeline.hpp"
+
+namespace {
+
+template <typename Pipeline>
+std::pair<std::string, std::unique_ptr<Compressor> (*)()> pipelineEntry() {
+    return {
+        Pipeline::pipelineName(),
+        +[]() -> std::unique_ptr<Compressor> { return std::make_unique<Pipeline>(); }
+    };
+}
+
+} // namespace
+
+std::string TruncateTransform::usage() {
+    return "  truncPrecision=<int>    Mantissa bits kept by trunc, 1 to 23. Default is 23 (lossless).\n";
+}
+
+void TruncateTransform::configure(const PipelineOptions& options) {
+    if (const auto it = options.find("truncPrecision"); it != options.end()) {
+        _truncPrecision = std::stoi(it->second);
+
+        // Validate
+        if (_truncPrecision < 1 || _truncPrecision > 23) {
+            throw std::invalid_argument("Invalid truncPrecision: " + it->second + ". Must be between 1 and 23.");
+        }
+    }
+    _mask = ~((1u << (23 - _truncPrecision)) - 1);
+}
+
+void TruncateTransform::addConfig(PipelineOptions& config) const {
+    config["truncPrecision"] = std::to_string(_truncPrecision);
+}
+
+std::string XorTransform::usage() {
+    return "";
+}
+
+std::string ZstdCodec::usage() {
+    return "  compressionLevel=<int>  Set the zstd compression level. Default is 3.\n";
+}
+
+std::string ZstdCodec::version() {
+    return std::format("zstd {}", ZSTD_versionString());
+}
+
+void ZstdCodec::configure(const PipelineOptions& options) {
+    if (const auto it = options.find("compressionLevel"); it != options.end()) {
+        _compressionLevel = parseZstdLevel(it->second);
+    }
+}
+
+void ZstdCodec::addConfig(PipelineOptions& config) const {
+    config["compressionLevel"] = std::to_string(_compressionLevel);
+}
+
+std::size_t ZstdCodec::bound(std::size_t size) {
+    return ZSTD_compressBound(size);
+}
+
+std::size_t ZstdCodec::compress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out) {
+    return _contexts.compress(in, out, _compressionLevel);
+}
+
+void ZstdCodec::decompress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out) {
+    _contexts.decompress(in, out);
+}
+
+std::string ZlibCodec::usage() {
+    return "  compressionLevel=<int>  Set the zlib compression level, 0 to 9. Default is 6.\n";
+}
+
+std::string ZlibCodec::version() {
+    return std::format("zlib {}", zlibVersion());
+}
+
+void ZlibCodec::configure(const PipelineOptions& options) {
+    if (const auto it = options.find("compressionLevel"); it != options.end()) {
+        _compressionLevel = parseZlibLevel(it->second);
+    }
+}
+
+void ZlibCodec::addConfig(PipelineOptions& config) const {
+    config["compressionLevel"] = std::to_string(_compressionLevel);
+}
+
+std::size_t ZlibCodec::bound(std::size_t size) {
+    return compressBound(static_cast<uLong>(size));
+}
+
+std::size_t ZlibCodec::compress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out) {
+    return zlibCompress(in, out, _compressionLevel);
+}
+
+void ZlibCodec::decompress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out) {
+    zlibDecompress(in, out);
+}
+
+std::vector<std::pair<std::string, std::unique_ptr<Compressor> (*)()>> pipelineFactories() {
+    // Each combination is compiled here; add a line to offer another
+    return {
+        pipelineEntry<PipelineCompressor<ContiguousLayout, ZlibCodec, TruncateTransform>>(),
+        pipelineEntry<PipelineCompressor<ContiguousLayout, ZstdCodec, TruncateTransform>>(),
+        pipelineEntry<PipelineCompressor<ByteShuffleLayout, ZstdCodec>>(),
+        pipelineEntry<PipelineCompressor<ByteShuffleLayout, ZlibCodec, TruncateTransform>>(),
+        pipelineEntry<PipelineCompressor<ByteShuffleLayout, ZstdCodec, TruncateTransform>>(),
+        pipelineEntry<PipelineCompressor<ByteShuffleLayout, ZstdCodec, XorTransform>>(),
+        pipelineEntry<PipelineCompressor<ByteShuffleLayout, ZstdCodec, TruncateTransform, XorTransform>>(),
+    };
+}
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "BufferPool.hpp"
+#include "codecs.hpp"
+#include "CompressedOutput.hpp"
+#include "Compressor.hpp"
+
+// Compressors composed at compile time from a chain of stages, e.g.
+// trunc -> shuffle -> zstd. Each chunk is processed in a single pass: every
+// float goes through all elementwise transforms and is stored in its final
+// byte layout while it is still in registers, and the codec then compresses
+// the (cache-resident) transformed chunk. The stages are template arguments,
+// so the inner loop has no virtual calls and no option lookups; options are
+// parsed once, by configure().
+
+using PipelineOptions = std::map<std::string, std::string>;
+
+// Elementwise transform of the bits of one float. forward() is applied in
+// stage order when compressing, inverse() in reverse order when decompressing;
+// reset() is called at the start of every chunk, so stateful transforms (e.g.
+// differences to the previous value) see each chunk on its own.
+template <typename T>
+concept PipelineTransform = requires(T transform, const T constTransform, std::uint32_t bits,
+                                     const PipelineOptions& options, PipelineOptions& config) {
+    { T::kName } -> std::convertible_to<std::string_view>;
+    { T::usage() } -> std::convertible_to<std::string>;
+    transform.configure(options);
+    constTransform.addConfig(config);
+    transform.reset();
+    { transform.forward(bits) } -> std::same_as<std::uint32_t>;
+    { transform.inverse(bits) } -> std::same_as<std::uint32_t>;
+};
+
+// Where the transformed bits of element i of n are stored in the buffer
+// handed to the codec. kName is empty for the identity layout.
+template <typename L>
+concept PipelineLayout = requires(std::uint8_t* out, const std::uint8_t* in, std::size_t i, std::uint32_t bits) {
+    { L::kName } -> std::convertible_to<std::string_view>;
+    L::store(out, i, i, bits);
+    { L::load(in, i, i) } -> std::same_as<std::uint32_t>;
+};
+
+// Lossless byte codec at the end of the pipeline. Copying a codec yields an
+// independent one with the same configuration.
+template <typename C>
+concept PipelineCodec = std::copy_constructible<C> && requires(C codec, const C constCodec, std::size_t size,
+                                                                std::span<const std::uint8_t> in, std::span<std::uint8_t> out,
+                                                                const PipelineOptions& options, PipelineOptions& config) {
+    { C::kName } -> std::convertible_to<std::string_view>;
+    { C::usage() } -> std::convertible_to<std::string>;
+    { C::version() } -> std::convertible_to<std::string>;
+    codec.configure(options);
+    constCodec.addConfig(config);
+    { C::bound(size) } -> std::same_as<std::size_t>;
+    // Returns the number of bytes written
+    { codec.compress(in, out) } -> std::same_as<std::size_t>;
+    // Must fill out exactly; throws otherwise
+    codec.decompress(in, out);
+};
+
+// Zero the low mantissa bits, keeping truncPrecision of the 23 (lossy).
+class TruncateTransform {
+public:
+    static constexpr std::string_view kName = "trunc";
+    static std::string usage();
+
+    void configure(const PipelineOptions& options);
+    void addConfig(PipelineOptions& config) const;
+
+    void reset() {}
+    std::uint32_t forward(std::uint32_t bits) const { return bits & _mask; }
+    std::uint32_t inverse(std::uint32_t bits) const { return bits; }
+
+private:
+    int _truncPrecision = 23;   // Mantissa bits kept; 23 is lossless
+    std::uint32_t _mask = ~0u;
+};
+
+// XOR with the previous value's bits, so that slowly varying values turn into
+// runs of zero sign, exponent and leading mantissa bits.
+class XorTransform {
+public:
+    static constexpr std::string_view kName = "xor";
+    static std::string usage();
+
+    void configure(const PipelineOptions&) {}
+    void addConfig(PipelineOptions&) const {}
+
+    void reset() { _previous = 0; }
+    std::uint32_t forward(std::uint32_t bits) {
+        const std::uint32_t delta = bits ^ _previous;
+        _previous = bits;
+        return delta;
+    }
+    std::uint32_t inverse(std::uint32_t delta) {
+        _previous ^= delta;
+        return _previous;
+    }
+
+private:
+    std::uint32_t _previous = 0;
+};
+
+// Floats stored as they are.
+struct ContiguousLayout {
+    static constexpr std::string_view kName = "";
+
+    static void store(std::uint8_t* out, std::size_t i, std::size_t, std::uint32_t bits) {
+        std::memcpy(out + i * sizeof(bits), &bits, sizeof(bits));
+    }
+    static std::uint32_t load(const std::uint8_t* in, std::size_t i, std::size_t) {
+        std::uint32_t bits;
+        std::memcpy(&bits, in + i * sizeof(bits), sizeof(bits));
+        return bits;
+    }
+};
+
+// Byte k of every float stored in plane k, as in Blosc's shuffle filter, so
+// that the slowly changing sign and exponent bytes are contiguous.
+struct ByteShuffleLayout {
+    static constexpr std::string_view kName = "shuffle";
+
+    static void store(std::uint8_t* out, std::size_t i, std::size_t n, std::uint32_t bits) {
+        out[i] = static_cast<std::uint8_t>(bits);
+        out[n + i] = static_cast<std::uint8_t>(bits >> 8);
+        out[2 * n + i] = static_cast<std::uint8_t>(bits >> 16);
+        out[3 * n + i] = static_cast<std::uint8_t>(bits >> 24);
+    }
+    static std::uint32_t load(const std::uint8_t* in, std::size_t i, std::size_t n) {
+        return static_cast<std::uint32_t>(in[i])
+            | static_cast<std::uint32_t>(in[n + i]) << 8
+            | static_cast<std::uint32_t>(in[2 * n + i]) << 16
+            | static_cast<std::uint32_t>(in[3 * n + i]) << 24;
+    }
+};
+
+// zstd with contexts reused across chunks, as in ZstdCompressor.
+class ZstdCodec {
+public:
+    static constexpr std::string_view kName = "zstd";
+    static std::string usage();
+    static std::string version();
+
+    void configure(const PipelineOptions& options);
+    void addConfig(PipelineOptions& config) const;
+
+    static std::size_t bound(std::size_t size);
+    std::size_t compress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out);
+    void decompress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out);
+
+private:
+    int _compressionLevel = 3;
+    ZstdContexts _contexts;
+};
+
+// zlib's one-shot compress2() and uncompress(), as in ZlibCompressor.
+class ZlibCodec {
+public:
+    static constexpr std::string_view kName = "zlib";
+    static std::string usage();
+    static std::string version();
+
+    void configure(const PipelineOptions& options);
+    void addConfig(PipelineOptions& config) const;
+
+    static std::size_t bound(std::size_t size);
+    std::size_t compress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out);
+    void decompress(std::span<const std::uint8_t> in, std::span<std::uint8_t> out);
+
+private:
+    int _compressionLevel = 6;
+};
+
+// A Compressor made of the Transforms, in order, then the Layout, then the
+// Codec. Its name joins the stage names with '+', e.g. "trunc+shuffle+zstd";
+// configure() passes the options to every stage, each taking its own keys.
+template <PipelineLayout Layout, PipelineCodec Codec, PipelineTransform... Transforms>
+class PipelineCompressor final : public Compressor {
+public:
+    PipelineCompressor() = default;
+
+    // Scratch buffers are per instance and not copied
+    PipelineCompressor(const PipelineCompressor& other)
+        : Compressor(other), _transforms(other._transforms), _codec(other._codec)
+    {
+    }
+    PipelineCompressor& operator=(const PipelineCompressor&) = delete;
+
+    static std::string pipelineName() {
+        std::string joined;
+        for (std::string_view stage : {Transforms::kName..., Layout::kName, Codec::kName}) {
+            if (!stage.empty()) {
+                joined += joined.empty() ? "" : "+";
+                joined += stage;
+            }
+        }
+        return joined;
+    }
+
+    CompressedData compress(const std::vector<float>& data) override {
+        return compressViaScratch(*this, data);
+    }
+
+    std::size_t maxCompressedSize(std::size_t numFloats) const override {
+        return Codec::bound(numFloats * sizeof(float));
+    }
+
+    std::size_t compressInto(const std::vector<float>& data, std::span<std::uint8_t> output) override {
+        return compressChunk(data, output);
+    }
+
+    std::vector<float> decompress(const CompressedData& compressedData) override {
+        return decompressBytes(compressedData.data, compressedData.numFloats);
+    }
+
+    std::vector<float> decompressBytes(std::span<const std::uint8_t> bytes, std::size_t numFloats) override {
+        std::vector<float> decompressedData(numFloats);
+        decompressChunk(bytes, decompressedData);
+        return decompressedData;
+    }
+
+    void decompressInto(std::span<const std::uint8_t> bytes, std::span<float> output) override {
+        decompressChunk(bytes, output);
+    }
+
+    void compressChunksInto(
+        std::span<const std::vector<float>> chunks,
+        std::span<const std::span<std::uint8_t>> outputs,
+        std::span<std::size_t> sizes) override
+    {
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            sizes[i] = compressChunk(chunks[i], outputs[i]);
+        }
+    }
+
+    void decompressChunksInto(std::span<const CompressedData> chunks, std::span<float> output) override {
+        std::size_t offset = 0;
+        for (const auto& chunk : chunks) {
+            decompressChunk(chunk.data, output.subspan(offset, chunk.numFloats));
+            offset += chunk.numFloats;
+        }
+    }
+
+    void configure(const PipelineOptions& options) override {
+        std::apply([&](auto&... transforms) { (transforms.configure(options), ...); }, _transforms);
+        _codec.configure(options);
+    }
+
+    std::unique_ptr<Compressor> clone() const override {
+        return std::make_unique<PipelineCompressor>(*this);
+    }
+
+    std::map<std::string, std::string> getConfig() const override {
+        PipelineOptions config;
+        std::apply([&](const auto&... transforms) { (transforms.addConfig(config), ...); }, _transforms);
+        _codec.addConfig(config);
+        return config;
+    }
+
+    std::string name() const override {
+        return pipelineName();
+    }
+
+    std::string description() const override {
+        return "Statically composed pipeline " + pipelineName() + ", fusing its transforms into one pass per chunk.";
+    }
+
+    std::string version() const override {
+        return Codec::version();
+    }
+
+    std::string usage() const override {
+        std::string text = "Options:\n";
+        for (const std::string& stage : {Transforms::usage()..., Codec::usage()}) {
+            text += stage;
+        }
+        return text;
+    }
+
+private:
+    std::size_t compressChunk(std::span<const float> data, std::span<std::uint8_t> output) {
+        const std::size_t n = data.size();
+        const std::size_t inputSize = n * sizeof(float);
+        if (_transformed.size() < inputSize) {
+            _transformed = BufferPool::global().acquire(inputSize);
+        }
+
+        // One pass: every transform, then the store into the codec's input
+        resetTransforms();
+        std::uint8_t* transformed = _transformed.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            Layout::store(transformed, i, n, forward(std::bit_cast<std::uint32_t>(data[i])));
+        }
+
+        return _codec.compress(std::span<const std::uint8_t>(transformed, inputSize), output);
+    }
+
+    void decompressChunk(std::span<const std::uint8_t> bytes, std::span<float> output) {
+        const std::size_t n = output.size();
+        auto* out = reinterpret_cast<std::uint8_t*>(output.data());
+
+        // Without a layout, decode straight into the output and invert in place
+        const std::uint8_t* transformed = out;
+        if constexpr (Layout::kName.empty()) {
+            _codec.decompress(bytes, std::span<std::uint8_t>(out, output.size_bytes()));
+        } else {
+            if (_transformed.size() < output.size_bytes()) {
+                _transformed = BufferPool::global().acquire(output.size_bytes());
+            }
+            _codec.decompress(bytes, std::span<std::uint8_t>(_transformed.data(), output.size_bytes()));
+            transformed = _transformed.data();
+        }
+
+        resetTransforms();
+        for (std::size_t i = 0; i < n; ++i) {
+            output[i] = std::bit_cast<float>(inverse(Layout::load(transformed, i, n)));
+        }
+    }
+
+    void resetTransforms() {
+        std::apply([](auto&... transforms) { (transforms.reset(), ...); }, _transforms);
+    }
+
+    std::uint32_t forward(std::uint32_t bits) {
+        std::apply([&](auto&... transforms) { ((bits = transforms.forward(bits)), ...); }, _transforms);
+        return bits;
+    }
+
+    std::uint32_t inverse(std::uint32_t bits) {
+        return inverseFrom(bits, std::index_sequence_for<Transforms...>{});
+    }
+
+    // Apply the inverses last stage first
+    template <std::size_t... I>
+    std::uint32_t inverseFrom(std::uint32_t bits, std::index_sequence<I...>) {
+        ((bits = std::get<sizeof...(Transforms) - 1 - I>(_transforms).inverse(bits)), ...);
+        return bits;
+    }
+
+    std::tuple<Transforms...> _transforms;
+    Codec _codec;
+    // Input of the codec, reused across chunks; taken from the pool, so it
+    // is faulted in once rather than grown inside the timed region
+    PooledBuffer _transformed;
+};
+
+// Factories of the pre-instantiated pipelines, by name, for createCompressor().
+std::vector<std::pair<std::string, std::unique_ptr<Compressor> (*)()>> pipelineFactories();
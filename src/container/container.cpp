@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "container.hpp"
+
+static_assert(std::endian::native == std::endian::little,
+              "Container I/O assumes a little-endian host.");
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'B', 'C', 'H', 'U', 'N', 'K', 'S'};
+constexpr std::size_t kDataAlignment = 4096;
+
+// Largest number of bytes handed to a single writev call.
+constexpr std::size_t kMaxWriteBytes = std::size_t{64} << 20;
+
+// Serializes header fields into a byte buffer.
+class HeaderWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+        _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void putString(const std::string& value) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(value.size()));
+        _buffer.insert(_buffer.end(), value.begin(), value.end());
+    }
+
+    void putBytes(const std::vector<std::uint8_t>& value) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(value.size()));
+        _buffer.insert(_buffer.end(), value.begin(), value.end());
+    }
+
+    std::vector<std::uint8_t>& buffer() { return _buffer; }
+
+private:
+    std::vector<std::uint8_t> _buffer;
+};
+
+// Parses header fields from a mapped byte range, with bounds checking.
+class HeaderReader {
+public:
+    HeaderReader(const std::uint8_t* data, std::size_t size) : _data(data), _size(size) {}
+
+    template <typename T>
+    T get() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, _data + _pos, sizeof(T));
+        _pos += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        const auto length = get<std::uint32_t>();
+        require(length);
+        std::string value(reinterpret_cast<const char*>(_data + _pos), length);
+        _pos += length;
+        return value;
+    }
+
+    std::vector<std::uint8_t> getBytes() {
+        const auto length = get<std::uint32_t>();
+        require(length);
+        std::vector<std::uint8_t> value(_data + _pos, _data + _pos + length);
+        _pos += length;
+        return value;
+    }
+
+    std::size_t position() const { return _pos; }
+    std::size_t remaining() const { return _size - _pos; }
+
+private:
+    void require(std::size_t bytes) const {
+        if (bytes > _size - _pos) {
+            throw std::runtime_error("Container header is truncated.");
+        }
+    }
+
+    const std::uint8_t* _data;
+    std::size_t _size;
+    std::size_t _pos{0};
+};
+
+void writeAll(int fd, std::vector<iovec>& iov, const std::string& filepath) {
+    std::size_t first = 0;
+    while (first < iov.size()) {
+        const int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+        const ssize_t written = ::writev(fd, iov.data() + first, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::format(
+                "Failed to write container '{}': {}", filepath, std::strerror(errno)));
+        }
+
+        // Advance past fully written entries and trim a partially written one
+        std::size_t remaining = static_cast<std::size_t>(written);
+        while (first < iov.size() && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = static_cast<std::uint8_t*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+}
+
+} // namespace
+
+void writeContainer(
+    const std::string& filepath,
+    const ContainerInfo& info,
+    const std::vector<CompressedData>& compressedChunks
+)
+{
+    // Header
+    HeaderWriter header;
+    header.buffer().insert(header.buffer().end(), std::begin(kMagic), std::end(kMagic));
+    header.put<std::uint32_t>(kContainerVersion);
+    header.put<std::uint32_t>(0); // dataOffset, patched below
+    header.put<std::uint64_t>(compressedChunks.size());
+
+    std::uint64_t numFloats = 0;
+    for (const auto& chunk : compressedChunks) {
+        numFloats += chunk.numFloats;
+    }
+    header.put<std::uint64_t>(numFloats);
+    header.put<std::uint64_t>(info.chunkSize);
+
+    header.putString(info.compressor);
+    header.putString(info.inputFile);
+    header.putString(info.tree);
+    header.putString(info.branch);
+    header.put<std::uint32_t>(static_cast<std::uint32_t>(info.compressorConfig.size()));
+    for (const auto& [key, value] : info.compressorConfig) {
+        header.putString(key);
+        header.putString(value);
+    }
+    header.putBytes(info.dictionary);
+    if (!info.mask.empty() && info.mask.size() != (numFloats + 7) / 8) {
+        throw std::runtime_error("Container padding mask does not match the number of floats.");
+    }
+    header.putBytes(info.mask);
+
+    // Chunk index; offsets are relative to the start of the file
+    const std::size_t indexBytes = compressedChunks.size() * 3 * sizeof(std::uint64_t);
+    const std::size_t dataOffset =
+        (header.buffer().size() + indexBytes + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+    if (dataOffset > UINT32_MAX) {
+        throw std::runtime_error("Container header is too large.");
+    }
+
+    std::uint64_t offset = dataOffset;
+    for (const auto& chunk : compressedChunks) {
+        header.put<std::uint64_t>(offset);
+        header.put<std::uint64_t>(chunk.data.size());
+        header.put<std::uint64_t>(chunk.numFloats);
+        offset += chunk.data.size();
+    }
+    header.buffer().resize(dataOffset, 0);
+    const auto dataOffset32 = static_cast<std::uint32_t>(dataOffset);
+    std::memcpy(header.buffer().data() + sizeof(kMagic) + sizeof(std::uint32_t),
+                &dataOffset32, sizeof(dataOffset32));
+
+    // Gather header and payloads, then issue writes of up to kMaxWriteBytes
+    // each. They go to a temporary file that is renamed over filepath once
+    // complete, so an interrupted run never leaves a partial container.
+    const std::string tempPath = std::format("{}.{}.tmp", filepath, ::getpid());
+    const int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error(std::format(
+            "Failed to open container for writing '{}': {}", tempPath, std::strerror(errno)));
+    }
+
+    try {
+        std::vector<iovec> batch;
+        std::size_t batchBytes = 0;
+        auto addToBatch = [&](const std::uint8_t* data, std::size_t size) {
+            if (size == 0) {
+                return;
+            }
+            if (batchBytes + size > kMaxWriteBytes && !batch.empty()) {
+                writeAll(fd, batch, filepath);
+                batch.clear();
+                batchBytes = 0;
+            }
+            batch.push_back({const_cast<std::uint8_t*>(data), size});
+            batchBytes += size;
+        };
+
+        addToBatch(header.buffer().data(), header.buffer().size());
+        for (const auto& chunk : compressedChunks) {
+            addToBatch(chunk.data.data(), chunk.data.size());
+        }
+        writeAll(fd, batch, filepath);
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+
+    if (::close(fd) != 0) {
+        const int error = errno;
+        ::unlink(tempPath.c_str());
+        throw std::runtime_error(std::format(
+            "Failed to close container '{}': {}", tempPath, std::strerror(error)));
+    }
+    if (::rename(tempPath.c_str(), filepath.c_str()) != 0) {
+        const int error = errno;
+        ::unlink(tempPath.c_str());
+        throw std::runtime_error(std::format(
+            "Failed to move container into place at '{}': {}", filepath, std::strerror(error)));
+    }
+}
+
+void dropFromPageCache(const std::string& filepath) {
+    const int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::format(
+            "Failed to open '{}' to drop it from the page cache: {}", filepath, std::strerror(errno)));
+    }
+    // Dirty pages cannot be evicted, so flush them first
+    if (::fdatasync(fd) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::runtime_error(std::format(
+            "Failed to flush '{}' before dropping it from the page cache: {}", filepath, std::strerror(error)));
+    }
+    // Returns the error number instead of setting errno
+    if (const int error = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED); error != 0) {
+        ::close(fd);
+        throw std::runtime_error(std::format(
+            "Failed to drop '{}' from the page cache: {}", filepath, std::strerror(error)));
+    }
+    ::close(fd);
+}
+
+ContainerReader::ContainerReader(const std::string& filepath) {
+    const int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::format(
+            "Failed to open container '{}': {}", filepath, std::strerror(errno)));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error(std::format("Container '{}' is empty or unreadable.", filepath));
+    }
+    _mappingSize = static_cast<std::size_t>(st.st_size);
+
+    void* mapping = ::mmap(nullptr, _mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(std::format(
+            "Failed to mmap container '{}': {}", filepath, std::strerror(errno)));
+    }
+    _mapping = static_cast<const std::uint8_t*>(mapping);
+
+    // Chunks are read front to back
+    ::madvise(mapping, _mappingSize, MADV_SEQUENTIAL);
+
+    try {
+        HeaderReader header(_mapping, _mappingSize);
+
+        char magic[sizeof(kMagic)];
+        for (auto& c : magic) {
+            c = header.get<char>();
+        }
+        if (!std::equal(std::begin(magic), std::end(magic), std::begin(kMagic))) {
+            throw std::runtime_error(std::format("'{}' is not a LossBench container.", filepath));
+        }
+
+        // Version 1 containers have no dictionary
+        const auto version = header.get<std::uint32_t>();
+        if (version < 1 || version > kContainerVersion) {
+            throw std::runtime_error(std::format(
+                "Unsupported container version {} in '{}' (expected 1 to {}).",
+                version, filepath, kContainerVersion));
+        }
+
+        header.get<std::uint32_t>(); // dataOffset; chunk offsets are absolute
+        const auto numChunks = header.get<std::uint64_t>();
+        _info.numFloats = header.get<std::uint64_t>();
+        _info.chunkSize = header.get<std::uint64_t>();
+
+        _info.compressor = header.getString();
+        _info.inputFile = header.getString();
+        _info.tree = header.getString();
+        _info.branch = header.getString();
+        const auto numConfigItems = header.get<std::uint32_t>();
+        for (std::uint32_t i = 0; i < numConfigItems; ++i) {
+            std::string key = header.getString();
+            _info.compressorConfig[key] = header.getString();
+        }
+        if (version >= 2) {
+            _info.dictionary = header.getBytes();
+        }
+        _info.numValues = _info.numFloats;
+        if (version >= 3) {
+            _info.mask = header.getBytes();
+            if (!_info.mask.empty()) {
+                if (_info.mask.size() != (_info.numFloats + 7) / 8) {
+                    throw std::runtime_error(std::format(
+                        "Padding mask in container '{}' does not match its {} floats.", filepath, _info.numFloats));
+                }
+                _info.numValues = 0;
+                for (std::uint8_t bits : _info.mask) {
+                    _info.numValues += std::popcount(bits);
+                }
+            }
+        }
+        _info.compressedSizeBytes = _info.dictionary.size() + _info.mask.size();
+
+        // Each index entry is three uint64s; a corrupt count must not drive the reservation
+        constexpr std::size_t kIndexEntryBytes = 3 * sizeof(std::uint64_t);
+        if (numChunks > header.remaining() / kIndexEntryBytes) {
+            throw std::runtime_error(std::format(
+                "Container '{}' declares {} chunks, more than its header can index.", filepath, numChunks));
+        }
+        _index.reserve(numChunks);
+        std::uint64_t chunkFloats = 0;
+        for (std::uint64_t i = 0; i < numChunks; ++i) {
+            IndexEntry entry{
+                .offset = header.get<std::uint64_t>(),
+                .size = header.get<std::uint64_t>(),
+                .numFloats = header.get<std::uint64_t>()
+            };
+            if (entry.offset > _mappingSize || entry.size > _mappingSize - entry.offset) {
+                throw std::runtime_error(std::format(
+                    "Chunk {} in container '{}' extends past the end of the file.", i, filepath));
+            }
+            _info.compressedSizeBytes += entry.size;
+            chunkFloats += entry.numFloats;
+            _index.push_back(entry);
+        }
+        // Chunks are decompressed into consecutive slices of one output array
+        if (chunkFloats != _info.numFloats) {
+            throw std::runtime_error(std::format(
+                "Chunks in container '{}' hold {} floats, but the header says {}.",
+                filepath, chunkFloats, _info.numFloats));
+        }
+    } catch (...) {
+        ::munmap(const_cast<std::uint8_t*>(_mapping), _mappingSize);
+        throw;
+    }
+}
+
+ContainerReader::~ContainerReader() {
+    if (_mapping) {
+        ::munmap(const_cast<std::uint8_t*>(_mapping), _mappingSize);
+    }
+}
+
+ContainerChunk ContainerReader::chunk(std::size_t i) const {
+    const IndexEntry& entry = _index.at(i);
+    return {
+        .bytes = std::span<const std::uint8_t>(_mapping + entry.offset, entry.size),
+        .numFloats = entry.numFloats
+    };
+}
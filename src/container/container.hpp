@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Compressor.hpp"
+
+// LossBench container format (.lbc), version 3.
+//
+// A container holds the compressed chunks of one branch so that decompression
+// can be benchmarked separately from compression, e.g. from a cold page cache.
+// All integers are little-endian.
+//
+//   magic            8 bytes, "LBCHUNKS"
+//   version          uint32
+//   dataOffset       uint32, offset of the first chunk (page aligned)
+//   numChunks        uint64
+//   numFloats        uint64, total over all chunks
+//   chunkSize        uint64, requested chunk size in bytes
+//   compressor       string (uint32 length + bytes)
+//   inputFile        string
+//   tree             string
+//   branch           string
+//   numConfigItems   uint32, followed by that many (key, value) string pairs
+//   dictionary       bytes (uint32 length + bytes) shared by all chunks, may be
+//                    empty; absent in version 1
+//   mask             bytes, bit-packed validity of each float of a padded
+//                    layout (bit i % 8 of byte i / 8), empty for other
+//                    layouts; absent before version 3
+//   chunk index      numChunks x (offset uint64, size uint64, numFloats uint64)
+//   padding          up to dataOffset
+//   chunk data       chunks back to back, at the offsets given in the index
+inline constexpr std::uint32_t kContainerVersion = 3;
+
+// Provenance and layout of a container, stored in its header.
+struct ContainerInfo {
+    std::string compressor;
+    std::map<std::string, std::string> compressorConfig;
+    std::string inputFile;
+    std::string tree;
+    std::string branch;
+    std::size_t chunkSize{0};
+    // Shared by all chunks; pass to Compressor::setDictionary before decompressing
+    std::vector<std::uint8_t> dictionary;
+    // Validity of each decompressed float (padded layout only); pass to
+    // removePadding to recover the branch values
+    std::vector<std::uint8_t> mask;
+    // Floats in the chunks, including padding
+    std::size_t numFloats{0};
+    // Branch values: numFloats less the padding
+    std::size_t numValues{0};
+    // Chunks plus dictionary and mask
+    std::size_t compressedSizeBytes{0};
+};
+
+// A compressed chunk borrowed from a memory-mapped container.
+struct ContainerChunk {
+    std::span<const std::uint8_t> bytes;
+    std::size_t numFloats;
+};
+
+// Write compressed chunks to a container file, replacing any existing file.
+// The header and index are written first, followed by the chunk payloads in
+// large gathered writes, to a temporary file in the same directory that is
+// then renamed to filepath. Throws std::runtime_error on I/O failure.
+void writeContainer(
+    const std::string& filepath,
+    const ContainerInfo& info,
+    const std::vector<CompressedData>& compressedChunks);
+
+// Evict a file's pages from the OS page cache so the next read comes from disk.
+// Throws std::runtime_error if the file cannot be flushed or the kernel rejects
+// the eviction, so a run never reports a cold cache it did not get. Pages still
+// mapped by another process may stay resident.
+void dropFromPageCache(const std::string& filepath);
+
+// Read-only, zero-copy view of a container file via mmap.
+class ContainerReader {
+public:
+    // Map and validate a container; throws std::runtime_error if it is malformed.
+    explicit ContainerReader(const std::string& filepath);
+    ~ContainerReader();
+
+    ContainerReader(const ContainerReader&) = delete;
+    ContainerReader& operator=(const ContainerReader&) = delete;
+
+    const ContainerInfo& info() const { return _info; }
+    std::size_t numChunks() const { return _index.size(); }
+
+    // Borrow chunk i; the returned span is valid for the lifetime of the reader.
+    ContainerChunk chunk(std::size_t i) const;
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t numFloats;
+    };
+
+    const std::uint8_t* _mapping{nullptr};
+    std::size_t _mappingSize{0};
+    ContainerInfo _info;
+    std::vector<IndexEntry> _index;
+};
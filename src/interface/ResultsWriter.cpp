@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "ResultsWriter.hpp"
+
+namespace {
+
+// Open (creating if needed) and exclusively flock a file; closing releases the lock.
+class LockedFile {
+public:
+    LockedFile(const std::string& filepath, int flags) : _filepath(filepath) {
+        _fd = ::open(filepath.c_str(), flags | O_CREAT | O_CLOEXEC, 0644);
+        if (_fd < 0) {
+            throw std::runtime_error(std::format(
+                "Failed to open results file '{}': {}", filepath, std::strerror(errno)));
+        }
+        while (::flock(_fd, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                const int error = errno;
+                ::close(_fd);
+                throw std::runtime_error(std::format(
+                    "Failed to lock results file '{}': {}", filepath, std::strerror(error)));
+            }
+        }
+    }
+
+    ~LockedFile() {
+        ::close(_fd);
+    }
+
+    LockedFile(const LockedFile&) = delete;
+    LockedFile& operator=(const LockedFile&) = delete;
+
+    void writeAll(const std::string& text) {
+        std::size_t written = 0;
+        while (written < text.size()) {
+            const ssize_t n = ::write(_fd, text.data() + written, text.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::format(
+                    "Failed to write results file '{}': {}", _filepath, std::strerror(errno)));
+            }
+            written += static_cast<std::size_t>(n);
+        }
+    }
+
+private:
+    std::string _filepath;
+    int _fd;
+};
+
+// Result blocks keyed by branch name (see makeBenchmarkJSON)
+const std::set<std::string> kBranchKeyedBlocks{"histograms", "characterization", "root_baseline_branches"};
+
+void flattenInto(
+    const nlohmann::json& value,
+    const std::string& name,
+    const std::vector<std::string>& branches,
+    ResultsRow& row);
+
+// Flatten a block keyed by branch name without putting branch names into
+// column names: a single branch's block is flattened under the block's name,
+// and the blocks of several branches by their position in config.branches,
+// with the branch name in a <block>_<i>_branch column.
+void flattenBranchKeyed(
+    const nlohmann::json& value,
+    const std::string& name,
+    const std::vector<std::string>& branches,
+    ResultsRow& row)
+{
+    if (value.size() == 1) {
+        flattenInto(value.begin().value(), name, branches, row);
+        return;
+    }
+    for (const auto& [key, item] : value.items()) {
+        const auto position = std::find(branches.begin(), branches.end(), key) - branches.begin();
+        const std::string prefix = name + "_" + std::to_string(position);
+        row.strings[prefix + "_branch"] = key;
+        flattenInto(item, prefix, branches, row);
+    }
+}
+
+void flattenInto(
+    const nlohmann::json& value,
+    const std::string& name,
+    const std::vector<std::string>& branches,
+    ResultsRow& row)
+{
+    if (value.is_object()) {
+        // Only blocks whose keys are all branches of this result; e.g. the
+        // characterization of `lossbench characterize` is not keyed
+        bool branchKeyed = kBranchKeyedBlocks.contains(name) && !value.empty();
+        for (const auto& [key, item] : value.items()) {
+            branchKeyed = branchKeyed && std::find(branches.begin(), branches.end(), key) != branches.end();
+        }
+        if (branchKeyed) {
+            flattenBranchKeyed(value, name, branches, row);
+            return;
+        }
+        for (const auto& [key, item] : value.items()) {
+            flattenInto(item, name.empty() ? key : name + "_" + key, branches, row);
+        }
+    } else if (value.is_array()) {
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            flattenInto(value[i], name + "_" + std::to_string(i), branches, row);
+        }
+    } else if (value.is_boolean()) {
+        row.numbers[name] = value.get<bool>() ? 1.0 : 0.0;
+    } else if (value.is_number()) {
+        row.numbers[name] = value.get<double>();
+    } else if (value.is_string()) {
+        row.strings[name] = value.get<std::string>();
+    }
+}
+
+} // namespace
+
+ResultsRow flattenResultJSON(const nlohmann::json& entry) {
+    // Branches of a fields-layout group are joined with '+'
+    std::vector<std::string> branches;
+    const auto config = entry.find("config");
+    if (config != entry.end() && config->is_object()) {
+        const auto joined = config->find("branches");
+        if (joined != config->end() && joined->is_string()) {
+            std::stringstream stream(joined->get<std::string>());
+            for (std::string branch; std::getline(stream, branch, '+');) {
+                branches.push_back(branch);
+            }
+        }
+    }
+
+    ResultsRow row;
+    flattenInto(entry, "", branches, row);
+    return row;
+}
+
+ResultsWriter::ResultsWriter(std::string filepath, std::string format)
+    : _filepath(std::move(filepath)), _format(std::move(format))
+{
+    if (_format != "jsonl" && _format != "root") {
+        throw std::invalid_argument("Results format must be jsonl or root; saw '" + _format + "'");
+    }
+}
+
+ResultsWriter::~ResultsWriter() {
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        std::cerr << std::format("Failed to write {} results to {}: {}\n",
+                                 _pending.size(), _filepath, e.what());
+    }
+}
+
+void ResultsWriter::write(const nlohmann::json& entry) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_pending.empty()) {
+        _oldestPending = std::chrono::steady_clock::now();
+    }
+    _pending.push_back(entry);
+    if (_pending.size() >= kFlushRows ||
+        std::chrono::steady_clock::now() - _oldestPending >= kFlushInterval) {
+        flushLocked();
+    }
+}
+
+void ResultsWriter::flush() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    flushLocked();
+}
+
+void ResultsWriter::flushLocked() {
+    if (_pending.empty()) {
+        return;
+    }
+
+    if (_format == "jsonl") {
+        // One O_APPEND write under the lock keeps each batch contiguous
+        std::string text;
+        for (const auto& entry : _pending) {
+            text += entry.dump();
+            text += '\n';
+        }
+        LockedFile file(_filepath, O_WRONLY | O_APPEND);
+        file.writeAll(text);
+    } else {
+        // ROOT rewrites parts of the file, so lock a separate file for the whole update
+        std::vector<ResultsRow> rows;
+        rows.reserve(_pending.size());
+        for (const auto& entry : _pending) {
+            rows.push_back(flattenResultJSON(entry));
+        }
+        LockedFile lock(_filepath + ".lock", O_RDWR);
+        appendResultsTree(_filepath, "results", rows);
+    }
+    _pending.clear();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "root-utils.hpp"
+
+// Buffered sink for result lines, safe to share between processes.
+//
+// Results are written in batches: every kFlushRows results, when the oldest
+// buffered result is kFlushInterval old, on flush() and on destruction. Each
+// batch is written while holding an exclusive flock, so several lossbench
+// processes can append to the same results file without interleaving.
+//
+// Formats:
+//   jsonl -- one JSON object per line
+//   root  -- one entry per result in TTree "results", with nested JSON
+//            flattened into columns (see flattenResultJSON)
+class ResultsWriter {
+public:
+    static constexpr std::size_t kFlushRows = 256;
+    static constexpr std::chrono::seconds kFlushInterval{10};
+
+    // Throws std::invalid_argument if format is not jsonl or root.
+    ResultsWriter(std::string filepath, std::string format = "jsonl");
+
+    // Flush remaining results; errors are reported on stderr.
+    ~ResultsWriter();
+
+    ResultsWriter(const ResultsWriter&) = delete;
+    ResultsWriter& operator=(const ResultsWriter&) = delete;
+
+    // Buffer one result. Thread-safe.
+    void write(const nlohmann::json& entry);
+
+    // Write all buffered results; throws std::runtime_error on I/O failure.
+    void flush();
+
+    const std::string& filepath() const { return _filepath; }
+
+private:
+    void flushLocked();
+
+    std::string _filepath;
+    std::string _format;
+    std::vector<nlohmann::json> _pending;
+    std::chrono::steady_clock::time_point _oldestPending;
+    std::mutex _mutex;
+};
+
+// Flatten a result into columns: nested keys are joined with '_' (e.g.
+// config_compressor_config_errorBound), array elements get their index as
+// the last key, booleans become 0/1 and nulls are dropped. Blocks keyed by
+// branch name (histograms, characterization, root_baseline.branches) do not
+// put the name into columns: a single branch's block is flattened as if
+// unkeyed (histograms_ks_distance), and the blocks of a fields-layout group
+// by position in config.branches (histograms_0_ks_distance, with the name in
+// histograms_0_branch).
+ResultsRow flattenResultJSON(const nlohmann::json& entry);
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "campaign.hpp"
+#include "root-utils.hpp"
+#include "tuner.hpp"
+
+namespace {
+
+const std::set<std::string> kSpecKeys{
+    "inputFiles", "synthetic", "tree", "branches", "chunkSize", "layout",
+    "compressors", "histBins", "characterize", "rootBaseline", "rootBasketSize",
+    "resultsFile", "resultsFormat", "jobThreads"
+};
+
+// A spec value given either as a single item or as a list of items.
+template <typename T>
+std::vector<T> asList(const nlohmann::json& value) {
+    if (value.is_array()) {
+        return value.get<std::vector<T>>();
+    }
+    return {value.get<T>()};
+}
+
+// 64-bit FNV-1a, as 16 hex digits.
+std::string hashId(const std::string& text) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return std::format("{:016x}", hash);
+}
+
+// Identifier of everything that determines a job's result.
+std::string jobId(const Args& args) {
+    nlohmann::json canonical = {
+        {"input_file", args.dataFile},
+        {"synthetic", args.synthetic},
+        {"tree", args.treename},
+        {"branches", args.branches},
+        {"chunk_size", args.chunkSize},
+        {"layout", args.layout},
+        {"compressor", args.compressor},
+        {"compressor_options", args.compressionOptions},
+        {"hist_bins", args.histBins}
+    };
+    // Settings that add blocks to the result; left out at their defaults so
+    // that jobs of campaigns without them keep their IDs
+    if (args.histRange) {
+        canonical["hist_range"] = {args.histRange->first, args.histRange->second};
+    }
+    if (args.characterize) {
+        canonical["characterize"] = true;
+    }
+    if (!args.rootBaseline.empty()) {
+        canonical["root_baseline"] = args.rootBaseline;
+        canonical["root_basket_size"] = args.rootBasketSize;
+    }
+    return hashId(canonical.dump());
+}
+
+} // namespace
+
+Campaign loadCampaign(const std::string& specPath, const Args& base) {
+    std::ifstream in(specPath);
+    if (!in) {
+        throw std::runtime_error("Failed to open campaign spec: " + specPath);
+    }
+
+    nlohmann::json spec;
+    try {
+        spec = nlohmann::json::parse(in);
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error(std::format("Invalid campaign spec '{}': {}", specPath, e.what()));
+    }
+    if (!spec.is_object()) {
+        throw std::runtime_error("Campaign spec must be a JSON object: " + specPath);
+    }
+    for (const auto& [key, value] : spec.items()) {
+        if (!kSpecKeys.contains(key)) {
+            throw std::runtime_error(std::format("Unknown key '{}' in campaign spec '{}'", key, specPath));
+        }
+    }
+
+    Campaign campaign;
+    try {
+        // Validate
+        if (spec.contains("inputFiles") == spec.contains("synthetic")) {
+            throw std::runtime_error("exactly one of inputFiles and synthetic is required");
+        }
+        if (spec.contains("inputFiles") && !spec.contains("tree")) {
+            throw std::runtime_error("tree is required with inputFiles");
+        }
+        for (const char* key : {"branches", "chunkSize", "compressors"}) {
+            if (!spec.contains(key)) {
+                throw std::runtime_error(std::format("{} is required", key));
+            }
+        }
+
+        Args common = base;
+        common.mode = "benchmark";
+        common.treename = spec.value("tree", "");
+        common.layout = spec.value("layout", "flat");
+        common.histBins = spec.value("histBins", common.histBins);
+        common.characterize = spec.value("characterize", common.characterize);
+        common.rootBaseline = spec.value("rootBaseline", common.rootBaseline);
+        common.rootBasketSize = spec.value("rootBasketSize", common.rootBasketSize);
+        common.resultsFile = base.resultsFile.empty() ? spec.value("resultsFile", "") : base.resultsFile;
+        common.resultsFormat = spec.value("resultsFormat", base.resultsFormat);
+        campaign.jobThreads = spec.value("jobThreads", std::size_t{1});
+        common.branchThreads = std::max<std::size_t>(1, campaign.jobThreads);
+        if (common.resultsFile.empty()) {
+            throw std::runtime_error("resultsFile is required");
+        }
+        if (common.layout != "flat" && common.layout != "padded" && common.layout != "fields") {
+            throw std::runtime_error("layout must be flat, padded or fields");
+        }
+        if (!common.rootBaseline.empty()) {
+            parseRootCompressionSettings(common.rootBaseline);
+        }
+        if (common.rootBasketSize <= 0) {
+            throw std::runtime_error("rootBasketSize must be positive");
+        }
+
+        const bool synthetic = spec.contains("synthetic");
+        const auto inputs = asList<std::string>(synthetic ? spec["synthetic"] : spec["inputFiles"]);
+        const auto branches = asList<std::string>(spec["branches"]);
+        const auto chunkSizes = asList<std::size_t>(spec["chunkSize"]);
+
+        // The fields layout benchmarks all branches together as one stacked array
+        std::vector<std::vector<std::string>> branchGroups;
+        if (common.layout == "fields") {
+            branchGroups.push_back(branches);
+        } else {
+            for (const auto& branch : branches) {
+                branchGroups.push_back({branch});
+            }
+        }
+
+        // Compressor configurations, with '|' alternatives expanded
+        std::vector<std::pair<std::string, std::map<std::string, std::string>>> compressors;
+        for (const auto& entry : asList<std::string>(spec["compressors"])) {
+            const auto colon = entry.find(':');
+            const std::string name = entry.substr(0, colon);
+            const std::string options = colon == std::string::npos ? "" : entry.substr(colon + 1);
+            for (auto& point : expandTuningGrid(options)) {
+                compressors.emplace_back(name, std::move(point));
+            }
+        }
+
+        for (const auto& input : inputs) {
+            for (const auto& group : branchGroups) {
+                for (std::size_t chunkSize : chunkSizes) {
+                    for (const auto& [name, options] : compressors) {
+                        Args job = common;
+                        (synthetic ? job.synthetic : job.dataFile) = input;
+                        job.branches = group;
+                        job.chunkSize = chunkSize;
+                        job.compressor = name;
+                        job.compressionOptions = options;
+                        campaign.jobs.push_back({jobId(job), std::move(job)});
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::format("Invalid campaign spec '{}': {}", specPath, e.what()));
+    }
+    return campaign;
+}
+
+std::set<std::string> completedJobIds(
+    const std::string& resultsFile,
+    const std::string& resultsFormat
+)
+{
+    std::set<std::string> ids;
+    if (resultsFormat == "root") {
+        for (auto& id : readResultsStringColumn(resultsFile, "results", "config_job_id")) {
+            if (!id.empty()) {
+                ids.insert(std::move(id));
+            }
+        }
+        return ids;
+    }
+
+    std::ifstream in(resultsFile);
+    std::string line;
+    while (std::getline(in, line)) {
+        const nlohmann::json entry = nlohmann::json::parse(line, nullptr, false);
+        if (entry.is_discarded() || !entry.contains("config")) {
+            continue;
+        }
+        const auto& config = entry["config"];
+        if (config.contains("job_id") && config["job_id"].is_string()) {
+            ids.insert(config["job_id"].get<std::string>());
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "interface.hpp"
+
+// One benchmark run of a campaign: a single input, branch (or stacked branch
+// group for the fields layout), chunk size and compressor configuration.
+struct CampaignJob {
+    // Stable identifier derived from the job's settings, recorded as
+    // config.job_id in its result
+    std::string id;
+    // Settings for benchmarking args.branches as one group
+    Args args;
+};
+
+struct Campaign {
+    std::vector<CampaignJob> jobs;
+    // Jobs run concurrently within one process
+    std::size_t jobThreads{1};
+};
+
+// Expand a campaign spec (JSON) into jobs, in a deterministic order. Spec keys
+// mirror the command-line options:
+//   inputFiles | synthetic   list of ROOT files or synthetic specs
+//   tree                     tree name (ROOT input only)
+//   branches                 list of branches
+//   chunkSize                number or list of numbers
+//   layout                   [optional] flat, padded or fields
+//   compressors              list of name[:opt=a|b,...]; '|' alternatives are expanded
+//   histBins                 [optional] histogram bins
+//   characterize             [optional] true to characterize each branch
+//   resultsFile              results file, unless given on the command line
+//   resultsFormat            [optional] jsonl or root
+//   jobThreads               [optional] concurrent jobs per process
+// Settings not in the spec (e.g. --pinCpus) are taken from base.
+// Throws std::runtime_error on an invalid spec.
+Campaign loadCampaign(const std::string& specPath, const Args& base);
+
+// Job identifiers already recorded in a results file; empty if it does not exist.
+// Truncated or malformed JSONL lines (e.g. from a killed process) are skipped.
+std::set<std::string> completedJobIds(
+    const std::string& resultsFile,
+    const std::string& resultsFormat);
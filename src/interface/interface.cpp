@@ -1,7 +1,8 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <format>
 #include <iostream>
-#include <fstream>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -10,6 +11,8 @@
 #include <unistd.h>
 
 #include "interface.hpp"
+#include "platform.hpp"
+#include "synthetic.hpp"
 
 static std::vector<std::string> tokenize(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
@@ -46,12 +49,34 @@ static std::map<std::string, std::string> parseCompressorConfig(const std::strin
 Args parseArgs(int argc, char* argv[]) {
     Args args;
 
-    for (int i = 1; i < argc; ++i) {
+    // Optional subcommand before the first option
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]).rfind("--", 0) != 0) {
+        args.mode = argv[1];
+        if (args.mode != "benchmark" && args.mode != "decompress" &&
+            args.mode != "tune" && args.mode != "estimate" && args.mode != "characterize" &&
+            args.mode != "campaign" && args.mode != "scale") {
+            printUsage();
+            throw std::runtime_error("Unknown subcommand: " + args.mode);
+        }
+        first = 2;
+
+        // campaign <spec.json>
+        if (args.mode == "campaign" && argc > 2 && std::string(argv[2]).rfind("--", 0) != 0) {
+            args.campaignSpec = argv[2];
+            first = 3;
+        }
+    }
+
+    for (int i = first; i < argc; ++i) {
         std::string arg = argv[i];
 
         if (arg == "--inputFile" && i + 1 < argc) {
             // --inputFile <file>
             args.dataFile = argv[++i];
+        } else if (arg == "--synthetic" && i + 1 < argc) {
+            // --synthetic <generator[:key=value,...]>
+            args.synthetic = argv[++i];
         } else if (arg == "--tree" && i + 1 < argc) {
             // --tree <name>
             args.treename = argv[++i];
@@ -78,21 +103,155 @@ Args parseArgs(int argc, char* argv[]) {
         } else if (arg == "--resultsFile" && i + 1 < argc) {
             // --resultsFile <file>
             args.resultsFile = argv[++i];
+        } else if (arg == "--resultsFormat" && i + 1 < argc) {
+            // [--resultsFormat <jsonl|root>]
+            args.resultsFormat = argv[++i];
+            if (args.resultsFormat != "jsonl" && args.resultsFormat != "root") {
+                throw std::runtime_error("--resultsFormat must be jsonl or root; saw '" + args.resultsFormat + "'");
+            }
         } else if (arg == "--decompFile" && i + 1 < argc) {
             // [--decompFile <file>]
             args.decompFile = argv[++i];
+        } else if (arg == "--branchThreads" && i + 1 < argc) {
+            // [--branchThreads <number>]
+            args.branchThreads = std::stoul(argv[++i]);
+            if (args.branchThreads == 0) {
+                throw std::runtime_error("--branchThreads must be at least 1");
+            }
+        } else if (arg == "--pinCpus" && i + 1 < argc) {
+            // [--pinCpus <cpu list, e.g. 0-3,8>]
+            args.pinCpus = parseCpuList(argv[++i]);
+        } else if (arg == "--numaNode" && i + 1 < argc) {
+            // [--numaNode <number>]
+            args.numaNode = std::stoi(argv[++i]);
+            if (args.numaNode < 0) {
+                throw std::runtime_error("--numaNode must be non-negative");
+            }
+        } else if (arg == "--hugePages" && i + 1 < argc) {
+            // [--hugePages <none|thp|explicit>]
+            args.hugePages = parseHugePages(argv[++i]);
+        } else if (arg == "--layout" && i + 1 < argc) {
+            // [--layout <flat|padded|fields>]
+            args.layout = argv[++i];
+            if (args.layout != "flat" && args.layout != "padded" && args.layout != "fields") {
+                throw std::runtime_error("--layout must be flat, padded or fields; saw '" + args.layout + "'");
+            }
+        } else if (arg == "--histBins" && i + 1 < argc) {
+            // [--histBins <number>]
+            args.histBins = std::stoul(argv[++i]);
+        } else if (arg == "--histRange" && i + 1 < argc) {
+            // [--histRange <lo:hi>]
+            const std::string range = argv[++i];
+            const auto colon = range.find(':');
+            if (colon == std::string::npos) {
+                throw std::runtime_error("--histRange must be lo:hi; saw '" + range + "'");
+            }
+            args.histRange = std::make_pair(std::stod(range.substr(0, colon)), std::stod(range.substr(colon + 1)));
+            if (args.histRange->first >= args.histRange->second) {
+                throw std::runtime_error("--histRange must satisfy lo < hi");
+            }
+        } else if (arg == "--characterize") {
+            // [--characterize]
+            args.characterize = true;
+        } else if (arg == "--rootBaseline" && i + 1 < argc) {
+            // [--rootBaseline <zlib|lzma|lz4|zstd>:<level>]
+            args.rootBaseline = argv[++i];
+            parseRootCompressionSettings(args.rootBaseline);
+        } else if (arg == "--rootBasketSize" && i + 1 < argc) {
+            // [--rootBasketSize <bytes>]
+            args.rootBasketSize = std::stoi(argv[++i]);
+            if (args.rootBasketSize <= 0) {
+                throw std::runtime_error("--rootBasketSize must be positive");
+            }
+        } else if (arg == "--containerDir" && i + 1 < argc) {
+            // [--containerDir <dir>]
+            args.containerDir = argv[++i];
+        } else if (arg == "--containerFiles" && i + 1 < argc) {
+            // --containerFiles <file1,file2,...>
+            args.containerFiles = tokenize(argv[++i], ',');
+        } else if (arg == "--warmCache") {
+            // [--warmCache]
+            args.warmCache = true;
+        } else if (arg == "--target" && i + 1 < argc) {
+            // --target <metric=value>
+            args.tuneTarget = argv[++i];
+        } else if (arg == "--tuneParam" && i + 1 < argc) {
+            // [--tuneParam <name:lo:hi>]
+            args.tuneParam = argv[++i];
+        } else if (arg == "--tuneGrid" && i + 1 < argc) {
+            // [--tuneGrid <opt1=a|b,opt2=c|d>]
+            args.tuneGrid = argv[++i];
+        } else if (arg == "--tuneSteps" && i + 1 < argc) {
+            // [--tuneSteps <number>]
+            args.tuneSteps = std::stoi(argv[++i]);
+        } else if (arg == "--sampleFraction" && i + 1 < argc) {
+            // [--sampleFraction <fraction>]
+            args.sampleFraction = std::stod(argv[++i]);
+            if (args.sampleFraction <= 0.0 || args.sampleFraction > 1.0) {
+                throw std::runtime_error("--sampleFraction must be in (0, 1]");
+            }
+        } else if (arg == "--shard" && i + 1 < argc) {
+            // [--shard <i/N>]
+            const std::string shard = argv[++i];
+            const auto slash = shard.find('/');
+            if (slash == std::string::npos) {
+                throw std::runtime_error("--shard must be i/N; saw '" + shard + "'");
+            }
+            args.shardIndex = std::stoul(shard.substr(0, slash));
+            args.shardCount = std::stoul(shard.substr(slash + 1));
+            if (args.shardCount == 0 || args.shardIndex >= args.shardCount) {
+                throw std::runtime_error("--shard must satisfy 0 <= i < N; saw '" + shard + "'");
+            }
+        } else if (arg == "--maxThreads" && i + 1 < argc) {
+            // [--maxThreads <number>]
+            args.maxThreads = std::stoul(argv[++i]);
+            if (args.maxThreads == 0) {
+                throw std::runtime_error("--maxThreads must be at least 1");
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            // [--seed <number>]
+            args.seed = std::stoull(argv[++i]);
         } else {
             throw std::runtime_error("Unknown or incomplete argument: " + arg);
         }
     }
 
-    if (args.dataFile.empty() || args.treename.empty() ||
-        args.branches.empty() || args.chunkSize == 0 ||
+    // Synthetic input needs no file or tree and defaults to all generated branches
+    if (!args.synthetic.empty()) {
+        const SyntheticSpec spec = parseSyntheticSpec(args.synthetic);
+        if (args.branches.empty()) {
+            args.branches = syntheticBranches(spec);
+        }
+    }
+    const bool haveInput = !args.synthetic.empty() || (!args.dataFile.empty() && !args.treename.empty());
+
+    if (args.mode == "campaign") {
+        // Everything else comes from the spec
+        if (args.campaignSpec.empty()) {
+            printUsage();
+            throw std::runtime_error("Missing campaign spec");
+        }
+    } else if (args.mode == "decompress") {
+        if (args.containerFiles.empty() || args.resultsFile.empty()) {
+            printUsage();
+            throw std::runtime_error("Missing required arguments");
+        }
+    } else if (args.mode == "characterize") {
+        if (!haveInput || args.branches.empty()) {
+            printUsage();
+            throw std::runtime_error("Missing required arguments");
+        }
+    } else if (!haveInput || args.branches.empty() || args.chunkSize == 0 ||
         args.compressor.empty()) {
         printUsage();
         throw std::runtime_error("Missing required arguments");
     }
 
+    if (args.mode == "tune" && (args.tuneTarget.empty() || args.resultsFile.empty())) {
+        printUsage();
+        throw std::runtime_error("Missing required arguments");
+    }
+
     return args;
 }
 
@@ -104,18 +263,134 @@ void printUsage() {
                  "--chunkSize <number> "
                  "--compressor <name[:opt1=val,opt2=val,...]> "
                  "[--resultsFile <file>] "
-                 "[--decompFile <file>]"
+                 "[--decompFile <file>] "
+                 "[--layout <flat|padded|fields>] "
+                 "[--branchThreads <number>] "
+                 "[--histBins <number>] "
+                 "[--histRange <lo:hi>] "
+                 "[--characterize] "
+                 "[--rootBaseline <algorithm:level>] "
+                 "[--rootBasketSize <bytes>] "
+                 "[--containerDir <dir>] "
+                 "[--resultsFormat <jsonl|root>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "       lossbench decompress "
+                 "--containerFiles <file1,file2,...> "
+                 "--resultsFile <file> "
+                 "[--warmCache] "
+                 "[--resultsFormat <jsonl|root>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "       lossbench tune "
+                 "--inputFile <file> "
+                 "--tree <name> "
+                 "--branches <branch1,branch2,...> "
+                 "--chunkSize <number> "
+                 "--compressor <name[:opt1=val,opt2=val,...]> "
+                 "--resultsFile <file> "
+                 "--target <maxAbsError|maxRelError|minPSNR|minRatio=value> "
+                 "[--tuneParam <name:lo:hi>] "
+                 "[--tuneGrid <opt1=a|b,opt2=c|d>] "
+                 "[--tuneSteps <number>] "
+                 "[--sampleFraction <fraction>] "
+                 "[--seed <number>] "
+                 "[--resultsFormat <jsonl|root>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "       lossbench estimate "
+                 "--inputFile <file> "
+                 "--tree <name> "
+                 "--branches <branch1,branch2,...> "
+                 "--chunkSize <number> "
+                 "--compressor <name[:opt1=val,opt2=val,...]> "
+                 "[--resultsFile <file>] "
+                 "[--sampleFraction <fraction>] "
+                 "[--seed <number>] "
+                 "[--resultsFormat <jsonl|root>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "       lossbench scale "
+                 "--inputFile <file> "
+                 "--tree <name> "
+                 "--branches <branch1,branch2,...> "
+                 "--chunkSize <number> "
+                 "--compressor <name[:opt1=val,opt2=val,...]> "
+                 "[--maxThreads <number>] "
+                 "[--resultsFile <file>] "
+                 "[--resultsFormat <jsonl|root>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "       lossbench characterize "
+                 "--inputFile <file> "
+                 "--tree <name> "
+                 "--branches <branch1,branch2,...> "
+                 "[--resultsFile <file>] "
+                 "[--resultsFormat <jsonl|root>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "       lossbench campaign <spec.json> "
+                 "[--shard <i/N>] "
+                 "[--resultsFile <file>] "
+                 "[--pinCpus <list>] "
+                 "[--numaNode <number>] "
+                 "[--hugePages <none|thp|explicit>]"
+                 "\n"
+                 "Instead of --inputFile and --tree, any mode except decompress accepts "
+                 "--synthetic <jets[:entries=N,seed=N,...]>; --branches then defaults to all generated branches."
                  "\n";
 }
 
 void printArgs(const Args& args) {
     std::cout << "---------- Command-Line Arguments ----------\n";
-    std::cout << "Input file: " << args.dataFile << "\n";
-    std::cout << "Tree name: " << args.treename << "\n";
+    std::cout << "Mode: " << args.mode << "\n";
+    std::cout << "Results format: " << args.resultsFormat << "\n";
+    std::cout << "Pinned CPUs: " << (args.pinCpus.empty() ? "None" : formatCpuList(args.pinCpus)) << "\n";
+    std::cout << "NUMA node: " << (args.numaNode < 0 ? "None" : std::to_string(args.numaNode)) << "\n";
+    std::cout << "Huge pages: " << formatHugePages(args.hugePages) << "\n";
+    if (args.mode == "campaign") {
+        std::cout << "Campaign spec: " << args.campaignSpec << "\n";
+        std::cout << "Shard: " << args.shardIndex << "/" << args.shardCount << "\n";
+        std::cout << "--------------------------------------------\n";
+        return;
+    }
+    if (args.mode == "decompress") {
+        std::cout << "Containers:\n";
+        for (const auto& file : args.containerFiles) {
+            std::cout << "  " << file << "\n";
+        }
+        std::cout << "Page cache: " << (args.warmCache ? "warm" : "cold") << "\n";
+        std::cout << "Results file: " << args.resultsFile << "\n";
+        std::cout << "--------------------------------------------\n";
+        return;
+    }
+    if (!args.synthetic.empty()) {
+        std::cout << "Synthetic input: " << args.synthetic << "\n";
+    } else {
+        std::cout << "Input file: " << args.dataFile << "\n";
+        std::cout << "Tree name: " << args.treename << "\n";
+    }
     std::cout << "Branches:\n";
     for (const auto& branch : args.branches) {
         std::cout << "  " << branch  << std::endl;
     }
+    if (args.mode == "characterize") {
+        std::cout << "Results file: " << (args.resultsFile.empty() ? "None" : args.resultsFile) << "\n";
+        std::cout << "--------------------------------------------\n";
+        return;
+    }
     std::cout << "Chunk size: " << args.chunkSize << "\n";
     std::cout << "Compressor: " << args.compressor << "\n";
     std::cout << "Compression options:\n";
@@ -128,6 +403,36 @@ void printArgs(const Args& args) {
     } else {
         std::cout << "Decompressed output: None\n";
     }
+    std::cout << "Layout: " << args.layout << "\n";
+    std::cout << "Branch threads: " << args.branchThreads << "\n";
+    if (args.mode == "benchmark") {
+        std::cout << "Histogram bins: " << args.histBins << "\n";
+        std::cout << "Histogram range: "
+                  << (args.histRange ? std::format("[{}, {})", args.histRange->first, args.histRange->second) : "auto")
+                  << "\n";
+        std::cout << "Characterize: " << (args.characterize ? "yes" : "no") << "\n";
+        std::cout << "ROOT baseline: "
+                  << (args.rootBaseline.empty() ? "None" : std::format("{}, {} byte baskets", args.rootBaseline, args.rootBasketSize))
+                  << "\n";
+    }
+    if (!args.containerDir.empty()) {
+        std::cout << "Container directory: " << args.containerDir << "\n";
+    }
+    if (args.mode == "tune") {
+        std::cout << "Tuning target: " << args.tuneTarget << "\n";
+        std::cout << "Tuning parameter: " << (args.tuneParam.empty() ? "None" : args.tuneParam) << "\n";
+        std::cout << "Tuning grid: " << (args.tuneGrid.empty() ? "None" : args.tuneGrid) << "\n";
+        std::cout << "Bisection steps: " << args.tuneSteps << "\n";
+        std::cout << "Sample fraction: " << args.sampleFraction << "\n";
+        std::cout << "Seed: " << args.seed << "\n";
+    }
+    if (args.mode == "scale") {
+        std::cout << "Max threads: " << (args.maxThreads == 0 ? "all CPUs" : std::to_string(args.maxThreads)) << "\n";
+    }
+    if (args.mode == "estimate") {
+        std::cout << "Sample fraction: " << args.sampleFraction << "\n";
+        std::cout << "Seed: " << args.seed << "\n";
+    }
     std::cout << "--------------------------------------------\n";
 }
 
@@ -157,55 +462,486 @@ static std::string getTimestamp(bool filenameSafe=false) {
     return std::string(buffer);
 }
 
+// Host, time and the state of the CPU the calling thread runs on, shared by every
+// kind of result line so that results from different runs can be compared.
+static nlohmann::json makeSystemJSON(const Args& args) {
+    const SystemInfo info = collectSystemInfo();
+    return {
+        {"host", getHost()},
+        {"timestamp", getTimestamp()},
+        {"kernel", info.kernel},
+        {"cpu_model", info.cpuModel},
+        {"cpu", info.cpu},
+        {"numa_node", info.numaNode},
+        {"cpu_governor", info.governor},
+        {"cpu_freq_mhz", info.cpuFrequencyMHz},
+        {"cpu_max_freq_mhz", info.cpuMaxFrequencyMHz},
+        {"smt", info.smt},
+        {"affinity", formatCpuList(info.affinity)},
+        {"pin_cpus", formatCpuList(args.pinCpus)},
+        {"membind_numa_node", args.numaNode},
+        {"huge_pages", formatHugePages(args.hugePages)}
+    };
+}
+
+// Page faults and scratch buffer allocation inside a timed region. The time the
+// faults cost is estimated from the pool's own prefaulting, which does little
+// else; with huge pages a prefault fault maps 2 MB, so there is no estimate.
+static nlohmann::json makeMemoryJSON(const MemoryStats& memory) {
+    const BufferPool& bufferPool = BufferPool::global();
+    const BufferPoolStats pool = bufferPool.stats();
+    const long faults = memory.pageFaults.minor + memory.pageFaults.major;
+    return {
+        {"minor_page_faults", memory.pageFaults.minor},
+        {"major_page_faults", memory.pageFaults.major},
+        {"estimated_fault_time_ms", pool.prefaultFaults > 0 && bufferPool.hugePages() == HugePages::None
+            ? nlohmann::json(faults * pool.mapElapsed.count() / pool.prefaultFaults)
+            : nlohmann::json(nullptr)},
+        {"pool_acquisitions", memory.pool.acquisitions},
+        {"pool_reuses", memory.pool.reuses},
+        {"pool_mapped_bytes", memory.pool.mappedBytes},
+        {"pool_huge_page_fallbacks", memory.pool.hugePageFallbacks},
+        {"pool_alloc_time_ms", memory.pool.mapElapsed.count()}
+    };
+}
+
+// Metrics and sizes, shared by every kind of result line.
+static nlohmann::json makeResultsJSON(
+    const BenchmarkResult& metrics,
+    std::size_t originalSizeBytes,
+    std::size_t compressedSizeBytes,
+    std::size_t numChunks)
+{
+    return {
+        {"original_size_bytes", originalSizeBytes},
+        {"compressed_size_bytes", compressedSizeBytes},
+        {"num_chunks", numChunks},
+        {"compression_ratio", metrics.compressionRatio},
+        {"compression_throughput_mbps", metrics.compressionThroughputMbps},
+        {"decompression_throughput_mbps", metrics.decompressionThroughputMbps},
+        {"abs_error_max", metrics.absErrorMax},
+        {"abs_error_avg", metrics.absErrorAvg},
+        {"rel_error_max", metrics.relErrorMax},
+        {"rel_error_avg", metrics.relErrorAvg},
+        {"mse", metrics.MSE},
+        {"psnr", metrics.PSNR}
+    };
+}
+
+// Characteristics of a branch's values and the compressors they suggest.
+static nlohmann::json makeCharacteristicsJSON(const DataCharacteristics& c) {
+    // Exponent counts, dense between the smallest and largest unbiased exponent in use
+    int lowest = 255;
+    int highest = 0;
+    for (int e = 1; e < 255; ++e) {
+        if (c.exponentHistogram[e] > 0) {
+            lowest = std::min(lowest, e);
+            highest = std::max(highest, e);
+        }
+    }
+    std::vector<std::uint64_t> exponentCounts;
+    for (int e = lowest; e <= highest; ++e) {
+        exponentCounts.push_back(c.exponentHistogram[e]);
+    }
+
+    nlohmann::json recommendations = nlohmann::json::array();
+    for (const auto& recommendation : recommendCompressors(c)) {
+        recommendations.push_back({
+            {"compressor", recommendation.compressor},
+            {"reason", recommendation.reason}
+        });
+    }
+
+    return {
+        {"num_values", c.numValues},
+        {"non_finite_values", c.nonFiniteValues},
+        {"zero_values", c.zeroValues},
+        {"min", c.min},
+        {"max", c.max},
+        {"mean", c.mean},
+        {"stddev", c.stddev},
+        {"distinct_estimate", c.distinctEstimate},
+        {"distinct_fraction", c.distinctFraction},
+        {"distinct_sketch_size", c.sketchSize},
+        {"byte_plane_entropy_bits", c.bytePlaneEntropy},
+        {"exponent_histogram", {
+            {"min_exponent", exponentCounts.empty() ? 0 : lowest - 127},
+            {"counts", exponentCounts},
+            {"zero_subnormal", c.exponentHistogram[0]},
+            {"non_finite", c.exponentHistogram[255]}
+        }},
+        {"common_trailing_zero_bits", c.commonTrailingZeroBits},
+        {"mean_trailing_zero_bits", c.meanTrailingZeroBits},
+        {"lag1_correlation", c.lag1Correlation},
+        {"avx2", c.avx2},
+        {"time_ms", c.elapsed.count()},
+        {"recommendations", recommendations}
+    };
+}
+
+// ROOT's basket compression of the benchmarked branches, in total and per
+// branch. size_vs_root below 1 means the compressor beats ROOT's own files.
+static nlohmann::json makeRootBaselineJSON(
+    const Args& args,
+    const BenchmarkResult& metrics,
+    const std::map<std::string, RootBasketResult>& rootBaselines)
+{
+    const double originalMB = metrics.originalSizeBytes / (1024.0 * 1024.0);
+    RootBasketResult total;
+    nlohmann::json branches;
+    for (const auto& [name, b] : rootBaselines) {
+        total.numEntries += b.numEntries;
+        total.numBaskets += b.numBaskets;
+        total.totBytes += b.totBytes;
+        total.zipBytes += b.zipBytes;
+        total.fileBytes += b.fileBytes;
+        total.writeElapsed += b.writeElapsed;
+        total.readElapsed += b.readElapsed;
+        branches[name] = {
+            {"entries", b.numEntries},
+            {"baskets", b.numBaskets},
+            {"tot_bytes", b.totBytes},
+            {"zip_bytes", b.zipBytes},
+            {"file_bytes", b.fileBytes},
+            {"write_time_ms", b.writeElapsed.count()},
+            {"read_time_ms", b.readElapsed.count()}
+        };
+    }
+
+    return {
+        {"compression", args.rootBaseline},
+        {"compression_settings", parseRootCompressionSettings(args.rootBaseline)},
+        {"basket_size", args.rootBasketSize},
+        {"entries", total.numEntries},
+        {"baskets", total.numBaskets},
+        {"tot_bytes", total.totBytes},
+        {"zip_bytes", total.zipBytes},
+        {"file_bytes", total.fileBytes},
+        {"compression_ratio", static_cast<double>(metrics.originalSizeBytes) / total.zipBytes},
+        {"size_vs_root", static_cast<double>(metrics.compressedSizeBytes) / total.zipBytes},
+        {"write_time_ms", total.writeElapsed.count()},
+        {"read_time_ms", total.readElapsed.count()},
+        {"write_throughput_mbps", originalMB / (total.writeElapsed.count() / 1000.0)},
+        {"read_throughput_mbps", originalMB / (total.readElapsed.count() / 1000.0)},
+        {"branches", branches}
+    };
+}
+
 nlohmann::json makeBenchmarkJSON(
     const Args& args,
     const std::map<std::string, std::string>& compressorConfig,
     const BenchmarkResult& metrics,
     const CompressionResult& comp,
+    const DecompressionResult& decomp,
+    const LayoutChunks& layout,
+    const std::map<std::string, HistogramComparison>& histograms,
+    const ErrorQuantiles& errorQuantiles,
+    const std::map<std::string, DataCharacteristics>& characteristics,
+    const std::map<std::string, RootBasketResult>& rootBaselines,
     std::string branch)
 {
     nlohmann::json j;
 
     // System info
-    j["system"] = {
-        {"host", getHost()},
-        {"timestamp", getTimestamp()}
-    };
+    j["system"] = makeSystemJSON(args);
 
     // Echo input configuration
     j["config"] = {
         {"input_file", args.dataFile},
+        {"synthetic", args.synthetic},
         {"tree", args.treename},
         {"branches", branch},
         {"chunk_size", args.chunkSize},
         {"compressor", args.compressor},
         {"compressor_config", compressorConfig},
         {"results_file", args.resultsFile},
-        {"decomp_file", args.decompFile}
+        {"decomp_file", args.decompFile},
+        {"container_dir", args.containerDir},
+        {"layout", args.layout},
+        {"branch_threads", args.branchThreads},
+        {"hist_bins", args.histBins}
+    };
+
+    // Metrics and sizes; the compressed size includes the layout's mask and the dictionary
+    j["results"] = makeResultsJSON(
+        metrics, metrics.originalSizeBytes, metrics.compressedSizeBytes, comp.compressedChunks.size()
+    );
+
+    // Shape handed to the compressor
+    j["layout"] = {
+        {"inner_dims", layout.innerDims},
+        {"padded_size_bytes", layout.paddedFloats * sizeof(float)},
+        {"mask_size_bytes", layout.mask.size()}
+    };
+
+    // Dictionary shared by all chunks, if the compressor trained one
+    j["dictionary"] = {
+        {"size_bytes", comp.dictionary.size()},
+        {"training_time_ms", comp.dictionaryElapsed.count()}
+    };
+
+    // Allocation and page faults included in the compression and decompression times
+    j["memory"] = {
+        {"compress", makeMemoryJSON(comp.memory)},
+        {"decompress", makeMemoryJSON(decomp.memory)}
+    };
+
+    // Tail of the pointwise errors, e.g. "p99.9"
+    nlohmann::json absQuantiles;
+    nlohmann::json relQuantiles;
+    for (std::size_t i = 0; i < errorQuantiles.probabilities.size(); ++i) {
+        const std::string name = std::format("p{}", 100.0 * errorQuantiles.probabilities[i]);
+        absQuantiles[name] = errorQuantiles.absError[i];
+        relQuantiles[name] = errorQuantiles.relError[i];
+    }
+    j["error_quantiles"] = {
+        {"sketch", "t-digest"},
+        {"compression", errorQuantiles.compression},
+        {"abs_error", absQuantiles},
+        {"rel_error", relQuantiles}
+    };
+
+    // Distribution fidelity per branch
+    if (!histograms.empty()) {
+        nlohmann::json& histogramsJSON = j["histograms"];
+        for (const auto& [name, h] : histograms) {
+            histogramsJSON[name] = {
+                {"bins", h.bins},
+                {"range", {h.lo, h.hi}},
+                {"ks_distance", h.ksDistance},
+                {"chi2", h.chi2},
+                {"ndf", h.ndf},
+                {"chi2_ndf", h.chi2PerNdf},
+                {"max_bin_deviation", h.maxBinDeviation},
+                {"max_bin_rel_deviation", h.maxBinRelDeviation},
+                {"underflow", {h.originalUnderflow, h.reconstructedUnderflow}},
+                {"overflow", {h.originalOverflow, h.reconstructedOverflow}}
+            };
+        }
+    }
+
+    // Properties of the original values per branch, with --characterize
+    if (!characteristics.empty()) {
+        nlohmann::json& characterizationJSON = j["characterization"];
+        for (const auto& [name, c] : characteristics) {
+            characterizationJSON[name] = makeCharacteristicsJSON(c);
+        }
+    }
+
+    // The same branches stored by ROOT itself, with --rootBaseline
+    if (!rootBaselines.empty()) {
+        j["root_baseline"] = makeRootBaselineJSON(args, metrics, rootBaselines);
+    }
+
+    return j;
+}
+
+nlohmann::json makeTuningJSON(
+    const Args& args,
+    const TuningCandidate& candidate,
+    const TuningOptions& tuning,
+    std::string branch)
+{
+    nlohmann::json j;
+
+    // System info
+    j["system"] = makeSystemJSON(args);
+
+    // Echo input configuration
+    j["config"] = {
+        {"mode", args.mode},
+        {"input_file", args.dataFile},
+        {"synthetic", args.synthetic},
+        {"tree", args.treename},
+        {"branches", branch},
+        {"chunk_size", args.chunkSize},
+        {"compressor", args.compressor},
+        {"compressor_config", candidate.compressorConfig},
+        {"results_file", args.resultsFile}
     };
 
-    // Metrics and sizes
+    // Full-branch metrics of the tuned configuration
+    j["results"] = makeResultsJSON(
+        candidate.metrics, candidate.originalSizeBytes, candidate.compressedSizeBytes, candidate.numChunks
+    );
+
+    // How the configuration was found
+    j["tuning"] = {
+        {"target", tuningTargetName(tuning.target)},
+        {"target_value", tuning.target.value},
+        {"parameter", tuning.parameter ? tuning.parameter->name : ""},
+        {"options", candidate.options},
+        {"sample_fraction", tuning.sampleFraction},
+        {"sample_evaluations", candidate.sampleEvaluations},
+        {"full_evaluations", candidate.fullEvaluations},
+        {"sample_compression_ratio", candidate.sampleMetrics.compressionRatio},
+        {"pareto", true}
+    };
+
+    return j;
+}
+
+nlohmann::json makeEstimateJSON(
+    const Args& args,
+    const std::map<std::string, std::string>& compressorConfig,
+    const EstimateResult& estimate,
+    std::string branch)
+{
+    nlohmann::json j;
+
+    // System info
+    j["system"] = makeSystemJSON(args);
+
+    // Echo input configuration
+    j["config"] = {
+        {"mode", args.mode},
+        {"input_file", args.dataFile},
+        {"synthetic", args.synthetic},
+        {"tree", args.treename},
+        {"branches", branch},
+        {"chunk_size", args.chunkSize},
+        {"compressor", args.compressor},
+        {"compressor_config", compressorConfig},
+        {"results_file", args.resultsFile}
+    };
+
+    // Point estimates, in the same layout as a full benchmark
+    j["results"] = makeResultsJSON(
+        estimate.metrics, estimate.originalSizeBytes, estimate.compressedSizeBytes, estimate.numChunks
+    );
+
+    auto interval = [](const Interval& ci) { return nlohmann::json::array({ci.lo, ci.hi}); };
+    j["estimate"] = {
+        {"is_estimate", true},
+        {"sample_fraction", args.sampleFraction},
+        {"seed", args.seed},
+        {"sampled_chunks", estimate.sampledChunks},
+        {"confidence_level", estimate.confidenceLevel},
+        {"max_errors_are_lower_bounds", true},
+        {"intervals", {
+            {"compression_ratio", interval(estimate.compressionRatio)},
+            {"compression_throughput_mbps", interval(estimate.compressionThroughputMbps)},
+            {"decompression_throughput_mbps", interval(estimate.decompressionThroughputMbps)},
+            {"abs_error_avg", interval(estimate.absErrorAvg)},
+            {"rel_error_avg", interval(estimate.relErrorAvg)},
+            {"mse", interval(estimate.MSE)},
+            {"psnr", interval(estimate.PSNR)}
+        }}
+    };
+
+    return j;
+}
+
+nlohmann::json makeScalingJSON(
+    const Args& args,
+    const ScalingStep& step,
+    std::string branch)
+{
+    nlohmann::json j;
+
+    // System info
+    j["system"] = makeSystemJSON(args);
+
+    // Echo input configuration
+    j["config"] = {
+        {"mode", args.mode},
+        {"input_file", args.dataFile},
+        {"synthetic", args.synthetic},
+        {"tree", args.treename},
+        {"branches", branch},
+        {"chunk_size", args.chunkSize},
+        {"compressor", args.compressor},
+        {"compressor_config", step.compressorConfig},
+        {"results_file", args.resultsFile}
+    };
+
+    j["results"] = makeResultsJSON(
+        step.metrics, step.metrics.originalSizeBytes, step.metrics.compressedSizeBytes, step.numChunks
+    );
+
+    // Relative to the sweep's first step, normally one thread
+    j["scaling"] = {
+        {"threads", step.threads},
+        {"parallelism", step.parallelism},
+        {"cpus", formatCpuList(step.cpus)},
+        {"compress_time_ms", step.compressElapsed.count()},
+        {"decompress_time_ms", step.decompressElapsed.count()},
+        {"compress_speedup", step.compressSpeedup},
+        {"decompress_speedup", step.decompressSpeedup},
+        {"compress_efficiency", step.compressEfficiency},
+        {"decompress_efficiency", step.decompressEfficiency},
+        {"ratio_change", step.ratioChange}
+    };
+
+    return j;
+}
+
+nlohmann::json makeDecompressionJSON(
+    const Args& args,
+    const std::string& containerFile,
+    const ContainerInfo& info,
+    const DecompressionResult& decomp)
+{
+    nlohmann::json j;
+
+    // System info
+    j["system"] = makeSystemJSON(args);
+
+    // Provenance comes from the container header
+    j["config"] = {
+        {"mode", args.mode},
+        {"container_file", containerFile},
+        {"cold_cache", !args.warmCache},
+        {"input_file", info.inputFile},
+        {"tree", info.tree},
+        {"branches", info.branch},
+        {"chunk_size", info.chunkSize},
+        {"compressor", info.compressor},
+        {"compressor_config", info.compressorConfig},
+        {"results_file", args.resultsFile}
+    };
+
+    // Padding is not part of the original data, as in the benchmark results
+    const std::size_t originalSizeBytes = info.numValues * sizeof(float);
+    const double decompressionThroughputMbps =
+        (originalSizeBytes / (1024.0 * 1024.0)) / (decomp.elapsed.count() / 1000.0);
+
     j["results"] = {
-        {"original_size_bytes", comp.compressedData.numFloats * sizeof(float)},
-        {"compressed_size_bytes", comp.compressedData.data.size()},
-        {"compression_ratio", metrics.compressionRatio},
-        {"compression_throughput_mbps", metrics.compressionThroughputMbps},
-        {"decompression_throughput_mbps", metrics.decompressionThroughputMbps},
-        {"abs_error_max", metrics.absErrorMax},
-        {"abs_error_avg", metrics.absErrorAvg},
-        {"rel_error_max", metrics.relErrorMax},
-        {"rel_error_avg", metrics.relErrorAvg},
-        {"mse", metrics.MSE},
-        {"psnr", metrics.PSNR}
+        {"original_size_bytes", originalSizeBytes},
+        {"compressed_size_bytes", info.compressedSizeBytes},
+        {"compression_ratio", static_cast<double>(originalSizeBytes) / info.compressedSizeBytes},
+        {"decompression_throughput_mbps", decompressionThroughputMbps}
+    };
+
+    // Allocation and page faults included in the decompression time, which
+    // also covers faults on the container mapping
+    j["memory"] = {
+        {"decompress", makeMemoryJSON(decomp.memory)}
     };
 
     return j;
 }
 
-void appendJSONL(const std::string& filepath, const nlohmann::json& entry) {
-    std::ofstream out(filepath, std::ios::app);
-    if (!out) {
-        throw std::runtime_error("Failed to open JSONL file for append: " + filepath);
-    }
-    out << entry.dump() << '\n';
+nlohmann::json makeCharacterizationJSON(
+    const Args& args,
+    const DataCharacteristics& characteristics,
+    std::string branch)
+{
+    nlohmann::json j;
+
+    // System info
+    j["system"] = makeSystemJSON(args);
+
+    // Echo input configuration
+    j["config"] = {
+        {"mode", args.mode},
+        {"input_file", args.dataFile},
+        {"synthetic", args.synthetic},
+        {"tree", args.treename},
+        {"branches", branch},
+        {"results_file", args.resultsFile}
+    };
+
+    j["characterization"] = makeCharacteristicsJSON(characteristics);
+    return j;
 }
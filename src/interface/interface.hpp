@@ -1,16 +1,38 @@
 #pragma once
 
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
 
 #include "benchmark.hpp"
+#include "BufferPool.hpp"
+#include "characterize.hpp"
+#include "container.hpp"
+#include "estimate.hpp"
+#include "histogram.hpp"
+#include "layout.hpp"
+#include "quantiles.hpp"
+#include "root-utils.hpp"
+#include "scaling.hpp"
+#include "tuner.hpp"
 
 // Command-line configuration
 struct Args {
+    // Subcommand: "benchmark" (default), "decompress", "tune", "estimate",
+    // "characterize" or "campaign"
+    std::string mode{"benchmark"};
+
+    // campaign: job manifest (see campaign.hpp), and the shard of its jobs to run
+    std::string campaignSpec;
+    std::size_t shardIndex{0};
+    std::size_t shardCount{1};
+
     std::string dataFile;
     std::string treename;
+    // [optional] generate input instead of reading dataFile, e.g. "jets:entries=1e8,seed=42"
+    std::string synthetic;
     std::vector<std::string> branches;
     std::size_t chunkSize{0};
 
@@ -18,7 +40,58 @@ struct Args {
     std::map<std::string, std::string> compressionOptions;
 
     std::string resultsFile;
+    // Results file format: "jsonl" (default) or "root" (see ResultsWriter.hpp)
+    std::string resultsFormat{"jsonl"};
     std::string decompFile;
+
+    // benchmark: number of branches benchmarked concurrently
+    std::size_t branchThreads{1};
+
+    // [optional] CPUs to run on, e.g. "2-5"; the main thread runs on all of
+    // them, and branch, campaign and scaling workers take one each round-robin
+    std::vector<int> pinCpus;
+    // [optional] NUMA node all memory is allocated on; -1 leaves placement to the kernel
+    int numaNode{-1};
+    // [optional] page size of the scratch buffers in BufferPool::global()
+    HugePages hugePages{HugePages::None};
+
+    // benchmark: value layout, one of flat, padded or fields (see layout.hpp)
+    std::string layout{"flat"};
+
+    // benchmark: histogram binning for distribution fidelity; 0 bins disables it
+    std::size_t histBins{100};
+    // benchmark: [optional] histogram range; default is each branch's original range
+    std::optional<std::pair<double, double>> histRange;
+
+    // benchmark: also characterize each branch's values (see characterize.hpp)
+    bool characterize{false};
+
+    // benchmark: [optional] also write each branch into an in-memory ROOT file
+    // with these compression settings, as <algorithm>:<level> (e.g. zstd:5)
+    std::string rootBaseline;
+    // benchmark: basket size of the ROOT baseline branch, in bytes
+    int rootBasketSize{32000};
+
+    // benchmark: write each branch's compressed chunks to <containerDir>/<branch>.lbc
+    std::string containerDir;
+    // decompress: containers to read back
+    std::vector<std::string> containerFiles;
+    // decompress: leave container pages in the page cache instead of evicting them
+    bool warmCache{false};
+
+    // scale: largest thread count of the sweep; 0 uses all CPUs the process may run on
+    std::size_t maxThreads{0};
+
+    // tune: target to meet, e.g. maxAbsError=1e-3
+    std::string tuneTarget;
+    // tune: [optional] numeric option to bisect, as name:lo:hi
+    std::string tuneParam;
+    // tune: [optional] option values to try, as opt1=a|b,opt2=c|d
+    std::string tuneGrid;
+    // tune/estimate: fraction of chunks sampled
+    double sampleFraction{0.05};
+    int tuneSteps{10};
+    std::uint64_t seed{42};
 };
 
 // Parse command-line arguments into Args; throws std::runtime_error on error.
@@ -36,7 +109,46 @@ nlohmann::json makeBenchmarkJSON(
     const std::map<std::string, std::string>& compressorConfig,
     const BenchmarkResult& metrics,
     const CompressionResult& comp,
+    const DecompressionResult& decomp,
+    const LayoutChunks& layout,
+    const std::map<std::string, HistogramComparison>& histograms,
+    const ErrorQuantiles& errorQuantiles,
+    const std::map<std::string, DataCharacteristics>& characteristics,
+    const std::map<std::string, RootBasketResult>& rootBaselines,
     std::string branch);
 
-// Append a JSON object as a single line to a JSONL file.
-void appendJSONL(const std::string& filepath, const nlohmann::json& entry);
+// Build a JSON object for a decompression run read back from a container.
+nlohmann::json makeDecompressionJSON(
+    const Args& args,
+    const std::string& containerFile,
+    const ContainerInfo& info,
+    const DecompressionResult& decomp);
+
+// Build a JSON object for one configuration found by the tuner.
+nlohmann::json makeTuningJSON(
+    const Args& args,
+    const TuningCandidate& candidate,
+    const TuningOptions& tuning,
+    std::string branch);
+
+// Build a JSON object for metrics extrapolated from a sample of chunks.
+// Uses the same schema as makeBenchmarkJSON, plus an "estimate" block.
+nlohmann::json makeEstimateJSON(
+    const Args& args,
+    const std::map<std::string, std::string>& compressorConfig,
+    const EstimateResult& estimate,
+    std::string branch);
+
+// Build a JSON object for one thread count of a scaling sweep.
+// Uses the same "results" block as makeBenchmarkJSON, plus a "scaling" block.
+nlohmann::json makeScalingJSON(
+    const Args& args,
+    const ScalingStep& step,
+    std::string branch);
+
+// Build a JSON object for a branch characterization, with compressor
+// recommendations.
+nlohmann::json makeCharacterizationJSON(
+    const Args& args,
+    const DataCharacteristics& characteristics,
+    std::string branch);
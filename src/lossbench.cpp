@@ -1,51 +1,502 @@
+#include <algorithm>
+#include <filesystem>
 #include <format>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <map>
 #include <random>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "interface.hpp"
 #include "root-utils.hpp"
 #include "factory.hpp"
 #include "benchmark.hpp"
+#include "BufferPool.hpp"
+#include "campaign.hpp"
+#include "characterize.hpp"
+#include "container.hpp"
+#include "estimate.hpp"
+#include "histogram.hpp"
+#include "layout.hpp"
+#include "platform.hpp"
+#include "quantiles.hpp"
+#include "scaling.hpp"
+#include "synthetic.hpp"
+#include "ResultsWriter.hpp"
+#include "ThreadPool.hpp"
+#include "tuner.hpp"
 
-int main(int argc, char* argv[]) {
+// Pin each pool worker to one of the --pinCpus, round-robin; the main thread
+// runs on all of them.
+static std::function<void(std::size_t)> workerPinning(const Args& args) {
+    return [cpus = args.pinCpus](std::size_t index) {
+        if (!cpus.empty()) {
+            pinCurrentThread({cpus[index % cpus.size()]});
+        }
+    };
+}
+
+// Read one branch from the input file, or generate it in memory for --synthetic input.
+static std::vector<float> loadBranch(
+    const Args& args,
+    const std::string& branch,
+    std::vector<std::uint32_t>& entrySizes
+)
+{
+    if (!args.synthetic.empty()) {
+        std::cout << "Generating data for branch '" << branch << "'...\n";
+        return generateSyntheticBranch(parseSyntheticSpec(args.synthetic), branch, entrySizes);
+    }
+    std::cout << "Reading data for branch '" << branch << "'...\n";
+    return readVectorFloatBranchData(args.dataFile, args.treename, branch, entrySizes);
+}
+
+static std::vector<float> loadBranch(const Args& args, const std::string& branch) {
+    std::vector<std::uint32_t> entrySizes;
+    return loadBranch(args, branch, entrySizes);
+}
+
+// Benchmark decompression of previously written containers, one result per container.
+static int runDecompress(const Args& args) {
+    ResultsWriter results(args.resultsFile, args.resultsFormat);
+    for (const auto& containerFile : args.containerFiles) {
+        if (!args.warmCache) {
+            dropFromPageCache(containerFile);
+        }
+
+        ContainerReader container(containerFile);
+        const ContainerInfo& info = container.info();
+        std::cout << std::format("Decompressing {} chunks of branch '{}' from {}...\n",
+                                 container.numChunks(), info.branch, containerFile);
+
+        // Recreate the compressor that wrote the container
+        std::unique_ptr<Compressor> compressor = createCompressor(info.compressor);
+        compressor->configure(info.compressorConfig);
+        compressor->setDictionary(info.dictionary);
+
+        DecompressionResult decompResult{timedDecompress(*compressor, container)};
+        // As in the benchmark, padding is dropped outside the timed region
+        if (!info.mask.empty()) {
+            decompResult.decompressedData = removePadding(decompResult.decompressedData, info.mask);
+        }
+
+        results.write(makeDecompressionJSON(args, containerFile, info, decompResult));
+        std::cout << "Appended results to " << args.resultsFile << "\n";
+    }
+    return 0;
+}
+
+// Search compressor options against a target and write the Pareto set per branch.
+static int runTune(const Args& args) {
+    TuningOptions tuning{
+        .target = parseTuningTarget(args.tuneTarget),
+        .parameter = args.tuneParam.empty()
+            ? std::nullopt
+            : std::optional<TuningParameter>(parseTuningParameter(args.tuneParam)),
+        .grid = expandTuningGrid(args.tuneGrid),
+        .sampleFraction = args.sampleFraction,
+        .steps = args.tuneSteps,
+        .seed = args.seed
+    };
+
+    std::unique_ptr<Compressor> compressor = createCompressor(args.compressor);
+    ResultsWriter results(args.resultsFile, args.resultsFormat);
+
+    for (const auto& branch : args.branches) {
+        std::vector<float> data{loadBranch(args, branch)};
+
+        std::vector<TuningCandidate> candidates{tuneCompressor(
+            *compressor, args.compressionOptions, data, args.chunkSize, tuning
+        )};
+        std::vector<TuningCandidate> front{paretoFront(candidates, tuning.target)};
+        if (front.empty()) {
+            std::cout << "No configuration met the target for branch '" << branch << "'.\n";
+        }
+
+        for (const auto& candidate : front) {
+            results.write(makeTuningJSON(args, candidate, tuning, branch));
+        }
+        std::cout << std::format("Appended {} Pareto-optimal configurations to {}\n",
+                                 front.size(), args.resultsFile);
+    }
+    return 0;
+}
+
+// Extrapolate benchmark metrics from a sample of each branch's chunks.
+static int runEstimate(const Args& args) {
+    std::unique_ptr<Compressor> compressor = createCompressor(args.compressor);
+    compressor->configure(args.compressionOptions);
+    ResultsWriter results(args.resultsFile, args.resultsFormat);
+
+    for (const auto& branch : args.branches) {
+        std::vector<float> data{loadBranch(args, branch)};
+
+        EstimateResult estimate{estimateBenchmarkMetrics(
+            *compressor, data, args.chunkSize, args.sampleFraction, args.seed
+        )};
+        std::cout << std::format("Estimated compression ratio {:.3f} [{:.3f}, {:.3f}] from {} of {} chunks\n",
+                                 estimate.metrics.compressionRatio,
+                                 estimate.compressionRatio.lo, estimate.compressionRatio.hi,
+                                 estimate.sampledChunks, estimate.numChunks);
+
+        results.write(makeEstimateJSON(args, compressor->getConfig(), estimate, branch));
+        std::cout << "Appended results to " << args.resultsFile << "\n";
+    }
+    return 0;
+}
+
+// Rerun each branch at 1, 2, 4, ... threads and report how the compressor scales.
+static int runScale(const Args& args) {
+    std::unique_ptr<Compressor> compressor = createCompressor(args.compressor);
+    compressor->configure(args.compressionOptions);
+    std::optional<ResultsWriter> results;
+    if (!args.resultsFile.empty()) {
+        results.emplace(args.resultsFile, args.resultsFormat);
+    }
+
+    // By default, every CPU the sweep may run on; the main thread has the
+    // whole --pinCpus list
+    std::size_t maxThreads = args.maxThreads;
+    if (maxThreads == 0) {
+        maxThreads = currentThreadAffinity().size();
+    }
+    const std::vector<std::size_t> threadCounts{scalingThreadCounts(maxThreads)};
+
+    for (const auto& branch : args.branches) {
+        std::vector<float> data{loadBranch(args, branch)};
+
+        std::vector<ScalingStep> steps{runScalingSweep(
+            *compressor, data, args.chunkSize, threadCounts, workerPinning(args)
+        )};
+        std::cout << std::format("Branch '{}' ({} parallelism):\n", branch, steps.front().parallelism);
+        for (const auto& step : steps) {
+            std::cout << std::format("  {:>3} threads: compression {:.1f} MB/s (x{:.2f}, {:.0f}%), "
+                                     "decompression {:.1f} MB/s (x{:.2f}, {:.0f}%), ratio {:.4f} ({:+.2f}%)\n",
+                                     step.threads,
+                                     step.metrics.compressionThroughputMbps, step.compressSpeedup,
+                                     100.0 * step.compressEfficiency,
+                                     step.metrics.decompressionThroughputMbps, step.decompressSpeedup,
+                                     100.0 * step.decompressEfficiency,
+                                     step.metrics.compressionRatio, 100.0 * step.ratioChange);
+            if (results) {
+                results->write(makeScalingJSON(args, step, branch));
+            }
+        }
+        if (results) {
+            std::cout << "Appended results to " << args.resultsFile << "\n";
+        }
+    }
+    return 0;
+}
+
+// Characterize each branch's values and suggest compressors, without compressing.
+static int runCharacterize(const Args& args) {
+    std::optional<ResultsWriter> results;
+    if (!args.resultsFile.empty()) {
+        results.emplace(args.resultsFile, args.resultsFormat);
+    }
+    // Every CPU this thread may run on, i.e. the --pinCpus list if given
+    const std::size_t threads = currentThreadAffinity().size();
+
+    for (const auto& branch : args.branches) {
+        std::vector<float> data{loadBranch(args, branch)};
+
+        DataCharacteristics characteristics{characterizeData(data, threads)};
+        std::cout << std::format("Branch '{}': {} values in [{}, {}], ~{:.2f}% distinct, "
+                                 "lag-1 correlation {:.3f} ({:.1f} ms)\n",
+                                 branch, characteristics.numValues, characteristics.min, characteristics.max,
+                                 100.0 * characteristics.distinctFraction, characteristics.lag1Correlation,
+                                 characteristics.elapsed.count());
+        for (const auto& recommendation : recommendCompressors(characteristics)) {
+            std::cout << "  --compressor " << recommendation.compressor << "\n"
+                      << "      " << recommendation.reason << "\n";
+        }
+
+        if (results) {
+            results->write(makeCharacterizationJSON(args, characteristics, branch));
+            std::cout << "Appended results to " << args.resultsFile << "\n";
+        }
+    }
+    return 0;
+}
+
+// Benchmark one branch, or one stacked group of branches for the fields layout,
+// and return its result line. Also writes the container if requested, to
+// <containerDir>/<containerName>.lbc, or <branch>.lbc if containerName is empty.
+static nlohmann::json benchmarkBranchGroup(
+    const Args& args,
+    Compressor& compressor,
+    const std::vector<std::string>& group,
+    const std::string& containerName
+)
+{
+    std::string branch = group.front();
+    for (std::size_t i = 1; i < group.size(); ++i) {
+        branch += "+" + group[i];
+    }
+
+    // The process's CPUs are shared between concurrently benchmarked branches.
+    // A branch worker may be pinned to one of them, but the pools it starts
+    // spread over all of them (see ThreadPool)
+    const std::size_t threads = std::max<std::size_t>(1, processAffinity().size() / args.branchThreads);
+
+    // Read data from ROOT file and arrange it for the compressor; branches are
+    // characterized and measured against ROOT's own compression before they
+    // are rearranged
+    std::vector<float> data;
+    LayoutChunks layout;
+    std::map<std::string, DataCharacteristics> characteristics;
+    std::map<std::string, RootBasketResult> rootBaselines;
+    const int rootCompression = args.rootBaseline.empty() ? 0 : parseRootCompressionSettings(args.rootBaseline);
+    std::vector<std::uint32_t> entrySizes;
+    if (args.layout == "fields") {
+        std::vector<std::vector<float>> fields;
+        for (const auto& field : group) {
+            fields.push_back(loadBranch(args, field, entrySizes));
+            if (args.characterize) {
+                characteristics[field] = characterizeData(fields.back(), threads);
+            }
+            if (!args.rootBaseline.empty()) {
+                rootBaselines[field] = measureRootBasketCompression(
+                    fields.back(), entrySizes, field, rootCompression, args.rootBasketSize);
+            }
+        }
+        // Interleave once and drop the separate fields before chunking
+        data = interleaveFields(fields);
+        fields.clear();
+        layout = makeFieldsLayout(data, group.size(), args.chunkSize);
+    } else if (args.layout == "padded") {
+        data = loadBranch(args, branch, entrySizes);
+        layout = makePaddedLayout(data, entrySizes, args.chunkSize);
+    } else {
+        data = loadBranch(args, branch, entrySizes);
+        layout = makeFlatLayout(data, args.chunkSize);
+    }
+    if (args.layout != "fields") {
+        if (args.characterize) {
+            characteristics[branch] = characterizeData(data, threads);
+        }
+        if (!args.rootBaseline.empty()) {
+            rootBaselines[branch] = measureRootBasketCompression(
+                data, entrySizes, branch, rootCompression, args.rootBasketSize);
+        }
+    }
+    // The flat layout has no dimensions, so a user-supplied innerDims option stays
+    if (!layout.innerDims.empty()) {
+        compressor.setInnerDims(layout.innerDims);
+    }
+
+    // Run benchmark
+    CompressionResult compResult{timedCompress(compressor, layout.chunks)};
+    compResult.overheadBytes = layout.mask.size();
+    DecompressionResult decompResult{timedDecompress(
+        compressor, compResult.compressedChunks
+    )};
+    if (!layout.mask.empty()) {
+        decompResult.decompressedData = removePadding(decompResult.decompressedData, layout.mask);
+    }
+
+    // Compute metrics
+    BenchmarkResult metrics{computeBenchmarkMetrics(
+        data, compResult, decompResult
+    )};
+
+    // Error quantiles, sketched per chunk-sized block
+    ErrorQuantiles errorQuantiles{computeErrorQuantiles(
+        data, decompResult.decompressedData, args.chunkSize / sizeof(float), threads
+    )};
+
+    // Compare distributions per branch; fields are compared in place in the interleaved data
+    std::map<std::string, HistogramComparison> histograms;
+    if (args.histBins > 0) {
+        const HistogramBinning binning{.bins = args.histBins, .range = args.histRange};
+        const std::size_t stride = args.layout == "fields" ? group.size() : 1;
+        for (std::size_t f = 0; f < stride; ++f) {
+            histograms[stride > 1 ? group[f] : branch] = compareHistograms(
+                data, decompResult.decompressedData, binning, threads, stride, f
+            );
+        }
+    }
+
+    // Output results as JSON
+    std::map<std::string, std::string> compressorConfig = compressor.getConfig();
+    nlohmann::json resultJSON = makeBenchmarkJSON(
+        args, compressorConfig, metrics, compResult, decompResult, layout, histograms, errorQuantiles, characteristics, rootBaselines, branch
+    );
+
+    // Persist compressed chunks for a later `lossbench decompress` run
+    if (!args.containerDir.empty()) {
+        const std::filesystem::path containerFile =
+            std::filesystem::path(args.containerDir)
+            / ((containerName.empty() ? branch : containerName) + ".lbc");
+        std::filesystem::create_directories(args.containerDir);
+        writeContainer(containerFile.string(), {
+            .compressor = args.compressor,
+            .compressorConfig = compressorConfig,
+            .inputFile = args.synthetic.empty() ? args.dataFile : "synthetic:" + args.synthetic,
+            .tree = args.treename,
+            .branch = branch,
+            .chunkSize = args.chunkSize,
+            .dictionary = compResult.dictionary,
+            .mask = layout.mask
+        }, compResult.compressedChunks);
+        std::cout << "Wrote compressed chunks to " << containerFile.string() << "\n";
+    }
+
+    return resultJSON;
+}
+
+// Run the jobs of a campaign shard that have no result yet, on a work-stealing pool.
+// JSONL results are flushed as soon as their job finishes, so an interrupted
+// campaign resumes where it stopped; ROOT results are written in batches.
+static int runCampaign(const Args& args) {
+    Campaign campaign{loadCampaign(args.campaignSpec, args)};
+    if (campaign.jobs.empty()) {
+        std::cout << "Campaign has no jobs.\n";
+        return 0;
+    }
+    const Args& common = campaign.jobs.front().args;
+    const std::set<std::string> completed{completedJobIds(common.resultsFile, common.resultsFormat)};
+
+    std::vector<const CampaignJob*> jobs;
+    std::size_t inShard = 0;
+    for (std::size_t k = 0; k < campaign.jobs.size(); ++k) {
+        if (k % args.shardCount != args.shardIndex) {
+            continue;
+        }
+        ++inShard;
+        if (!completed.contains(campaign.jobs[k].id)) {
+            jobs.push_back(&campaign.jobs[k]);
+        }
+    }
+    std::cout << std::format("Campaign: {} jobs, {} in shard {}/{}, {} already done, {} to run on {} threads\n",
+                             campaign.jobs.size(), inShard, args.shardIndex, args.shardCount,
+                             inShard - jobs.size(), jobs.size(), campaign.jobThreads);
+
+    ResultsWriter results(common.resultsFile, common.resultsFormat);
+    enableRootThreadSafety();
+    ThreadPool pool(campaign.jobThreads, workerPinning(args));
+    std::vector<std::future<void>> pending;
+    for (const CampaignJob* job : jobs) {
+        pending.push_back(pool.submit([&args, &common, &results, job]() {
+            std::unique_ptr<Compressor> compressor = createCompressor(job->args.compressor);
+            compressor->configure(job->args.compressionOptions);
+            // Jobs on the same branch run concurrently, so containers are named by job
+            nlohmann::json resultJSON = benchmarkBranchGroup(job->args, *compressor, job->args.branches, job->id);
+            resultJSON["config"]["job_id"] = job->id;
+            resultJSON["config"]["campaign"] = args.campaignSpec;
+            results.write(resultJSON);
+            // Appending a line is cheap, but every ROOT flush rewrites the tree,
+            // so ROOT results keep the writer's batching
+            if (common.resultsFormat == "jsonl") {
+                results.flush();
+            }
+        }));
+    }
+
+    // A failed job is reported and left for the next run
+    std::size_t failures = 0;
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        try {
+            pending[i].get();
+        } catch (const std::exception& e) {
+            ++failures;
+            std::cerr << std::format("Job {} ({} on {}) failed: {}\n",
+                                     jobs[i]->id, jobs[i]->args.compressor, jobs[i]->args.branches.front(), e.what());
+        }
+    }
+    std::cout << std::format("Campaign shard finished: {} jobs run, {} failed\n", jobs.size(), failures);
+    return failures > 0 ? 1 : 0;
+}
+
+static int run(int argc, char* argv[]) {
     // Parse command line arguments
     Args args = parseArgs(argc, argv);
     printArgs(args);
 
+    // Place memory and threads before any data is read, so that buffers are
+    // first touched on the chosen node and worker threads inherit the policy
+    if (args.numaNode >= 0) {
+        bindMemoryToNumaNode(args.numaNode);
+    }
+    // The main thread gets the whole list, so that the threads it starts
+    // (codec threads, internal pools) are not confined to one CPU; workers pin
+    // themselves to single CPUs through workerPinning
+    if (!args.pinCpus.empty()) {
+        pinCurrentThread(args.pinCpus);
+    }
+    BufferPool::global().setHugePages(args.hugePages);
+
+    if (args.mode == "decompress") {
+        return runDecompress(args);
+    } else if (args.mode == "tune") {
+        return runTune(args);
+    } else if (args.mode == "estimate") {
+        return runEstimate(args);
+    } else if (args.mode == "characterize") {
+        return runCharacterize(args);
+    } else if (args.mode == "campaign") {
+        return runCampaign(args);
+    } else if (args.mode == "scale") {
+        return runScale(args);
+    }
+
     // Create compressor
     std::unique_ptr<Compressor> compressor = createCompressor(args.compressor);
     compressor->configure(args.compressionOptions);
 
-    // Iterate over branches
-    for (const auto& branch : args.branches) {
-        // Read data from ROOT file
-        std::cout << "Reading data for branch '" << branch << "'...\n";
-        std::vector<float> data{readVectorFloatBranchData(
-            args.dataFile, args.treename, branch
-        )};
+    // The fields layout benchmarks all branches together as one stacked array
+    std::vector<std::vector<std::string>> branchGroups;
+    if (args.layout == "fields") {
+        branchGroups.push_back(args.branches);
+    } else {
+        for (const auto& branch : args.branches) {
+            branchGroups.push_back({branch});
+        }
+    }
 
-        // Run benchmark
-        CompressionResult compResult{timedCompress(*compressor, data)};
-        DecompressionResult decompResult{timedDecompress(
-            *compressor, compResult.compressedData
-        )};
+    ResultsWriter results(args.resultsFile, args.resultsFormat);
 
-        // Compute metrics
-        BenchmarkResult metrics{computeBenchmarkMetrics(
-            data, compResult, decompResult
-        )};
+    // Iterate over branches
+    if (args.branchThreads == 1) {
+        for (const auto& group : branchGroups) {
+            results.write(benchmarkBranchGroup(args, *compressor, group, {}));
+            std::cout << "Appended results to " << args.resultsFile << "\n";
+        }
+        return 0;
+    }
 
-        // Output results as JSON
-        std::map<std::string, std::string> compressorConfig = compressor->getConfig();
-        nlohmann::json resultJSON = makeBenchmarkJSON(
-            args, compressorConfig, metrics, compResult, branch
-        );
-        appendJSONL(args.resultsFile, resultJSON);
+    // Benchmark branches concurrently, each task with its own compressor clone.
+    // Results are written in branch order as soon as all earlier ones are done.
+    enableRootThreadSafety();
+    ThreadPool pool(std::min(args.branchThreads, branchGroups.size()), workerPinning(args));
+    std::vector<std::future<nlohmann::json>> pending;
+    for (const auto& group : branchGroups) {
+        pending.push_back(pool.submit([&args, &group, clone = compressor->clone()]() {
+            return benchmarkBranchGroup(args, *clone, group, {});
+        }));
+    }
+    for (auto& result : pending) {
+        results.write(result.get());
         std::cout << "Appended results to " << args.resultsFile << "\n";
     }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Catch here rather than terminate, so that result writers are destroyed
+    // and everything written before the error reaches the results file
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
 }
@@ -0,0 +1,524 @@
+// lossbench_microbench: throughput of every registered compressor over a
+// matrix of buffer sizes, synthetic data shapes and thread counts, with an
+// optional comparison against a baseline results file.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "benchmark.hpp"
+#include "factory.hpp"
+#include "platform.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+struct MicrobenchArgs {
+    std::string resultsFile;
+    std::string baselineFile;
+    // Fractional throughput loss against the baseline that counts as a regression
+    double threshold{0.10};
+
+    std::vector<std::string> compressors{listCompressors()};
+    std::vector<std::string> shapes{"smooth", "gaussian", "spectrum", "sparse"};
+    std::vector<std::size_t> sizes{4 << 10, 64 << 10, 1 << 20, 16 << 20, 64 << 20};
+    std::size_t chunkSize{1 << 20};
+    std::size_t threads{std::max(2u, std::thread::hardware_concurrency())};
+    int repeats{5};
+    std::uint64_t seed{42};
+    std::vector<int> pinCpus;
+};
+
+// One cell of the matrix.
+struct Case {
+    std::string compressor;
+    std::string shape;
+    std::size_t sizeBytes;
+    std::size_t threads;
+
+    std::string key() const {
+        return std::format("{}/{}/{}/{}", compressor, shape, sizeBytes, threads);
+    }
+};
+
+struct CaseResult {
+    double compressionRatio;
+    // Best and median over the repeats, in MB/s
+    double compressionBestMbps;
+    double compressionMedianMbps;
+    double decompressionBestMbps;
+    double decompressionMedianMbps;
+};
+
+std::vector<std::string> split(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::size_t start = 0;
+    while (start < str.size()) {
+        const std::size_t pos = str.find(delimiter, start);
+        if (pos == std::string::npos) {
+            tokens.push_back(str.substr(start));
+            break;
+        }
+        tokens.push_back(str.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return tokens;
+}
+
+// Parse a size such as 4096, 4K or 64M.
+std::size_t parseSize(const std::string& size) {
+    std::size_t suffixPos = 0;
+    const std::size_t value = std::stoul(size, &suffixPos);
+    const std::string suffix = size.substr(suffixPos);
+    if (suffix.empty()) {
+        return value;
+    } else if (suffix == "K" || suffix == "k") {
+        return value << 10;
+    } else if (suffix == "M" || suffix == "m") {
+        return value << 20;
+    } else if (suffix == "G" || suffix == "g") {
+        return value << 30;
+    }
+    throw std::invalid_argument("Invalid size: " + size);
+}
+
+void printUsage() {
+    std::cout << "Usage: lossbench_microbench "
+                 "--resultsFile <file> "
+                 "[--baseline <file>] "
+                 "[--threshold <fraction>] "
+                 "[--compressors <name1,name2,...>] "
+                 "[--shapes <smooth,gaussian,spectrum,sparse>] "
+                 "[--sizes <4K,64K,1M,...>] "
+                 "[--chunkSize <size>] "
+                 "[--threads <number>] "
+                 "[--repeats <number>] "
+                 "[--seed <number>] "
+                 "[--pinCpus <list>]"
+                 "\n";
+}
+
+MicrobenchArgs parseArgs(int argc, char* argv[]) {
+    MicrobenchArgs args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--resultsFile" && i + 1 < argc) {
+            args.resultsFile = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            args.baselineFile = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            args.threshold = std::stod(argv[++i]);
+            if (args.threshold <= 0.0 || args.threshold >= 1.0) {
+                throw std::runtime_error("--threshold must be in (0, 1)");
+            }
+        } else if (arg == "--compressors" && i + 1 < argc) {
+            args.compressors = split(argv[++i], ',');
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            args.shapes = split(argv[++i], ',');
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            args.sizes.clear();
+            for (const auto& size : split(argv[++i], ',')) {
+                args.sizes.push_back(parseSize(size));
+                if (args.sizes.back() < sizeof(float)) {
+                    throw std::runtime_error("--sizes must be at least 4 bytes each");
+                }
+            }
+        } else if (arg == "--chunkSize" && i + 1 < argc) {
+            args.chunkSize = parseSize(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            args.threads = std::stoul(argv[++i]);
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            args.repeats = std::stoi(argv[++i]);
+            if (args.repeats < 1) {
+                throw std::runtime_error("--repeats must be at least 1");
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            args.seed = std::stoull(argv[++i]);
+        } else if (arg == "--pinCpus" && i + 1 < argc) {
+            args.pinCpus = parseCpuList(argv[++i]);
+        } else if (arg == "--help") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::runtime_error("Unknown or incomplete argument: " + arg);
+        }
+    }
+
+    if (args.resultsFile.empty() || args.chunkSize == 0) {
+        printUsage();
+        throw std::runtime_error("Missing required arguments");
+    }
+    return args;
+}
+
+// Deterministic synthetic data:
+//   smooth   -- slowly varying signal with small noise (favours predictors)
+//   gaussian -- white noise (close to incompressible)
+//   spectrum -- exponentially falling values, like a pT spectrum
+//   sparse   -- 90% zeros, the rest from the spectrum
+std::vector<float> makeData(const std::string& shape, std::size_t numFloats, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<float> data(numFloats);
+    if (shape == "smooth") {
+        std::normal_distribution<float> noise(0.0f, 0.01f);
+        for (std::size_t i = 0; i < numFloats; ++i) {
+            data[i] = 100.0f * std::sin(static_cast<float>(i) * 1e-3f) + noise(rng);
+        }
+    } else if (shape == "gaussian") {
+        std::normal_distribution<float> value(0.0f, 1.0f);
+        std::generate(data.begin(), data.end(), [&] { return value(rng); });
+    } else if (shape == "spectrum") {
+        std::exponential_distribution<float> value(1.0f / 30.0f);
+        std::generate(data.begin(), data.end(), [&] { return value(rng); });
+    } else if (shape == "sparse") {
+        std::bernoulli_distribution nonZero(0.1);
+        std::exponential_distribution<float> value(1.0f / 30.0f);
+        std::generate(data.begin(), data.end(), [&] { return nonZero(rng) ? value(rng) : 0.0f; });
+    } else {
+        throw std::invalid_argument("Unknown data shape: " + shape);
+    }
+    return data;
+}
+
+// Run work(0..numTasks-1) on the pool, or inline without one, and return the
+// wall-clock time until all tasks have finished.
+template <typename F>
+Milliseconds timedTasks(ThreadPool* pool, std::size_t numTasks, F& work) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!pool) {
+        for (std::size_t task = 0; task < numTasks; ++task) {
+            work(task);
+        }
+    } else {
+        std::vector<std::future<void>> done;
+        for (std::size_t task = 0; task < numTasks; ++task) {
+            done.push_back(pool->submit([&work, task] { work(task); }));
+        }
+        for (auto& future : done) {
+            future.get();
+        }
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Compressed chunks of one case. If the compressor can bound its output, they
+// are slices of one buffer allocated and faulted in before timing, as in
+// lossbench (see timedCompress); otherwise compress() allocates them.
+struct CompressedChunks {
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::span<std::uint8_t>> outputs;
+    std::vector<std::size_t> sizes;
+    std::vector<CompressedData> allocated;
+
+    CompressedChunks(const Compressor& compressor, const std::vector<std::vector<float>>& chunks)
+        : outputs(chunks.size()), sizes(chunks.size())
+    {
+        std::vector<std::size_t> bounds;
+        for (const auto& chunk : chunks) {
+            bounds.push_back(compressor.maxCompressedSize(chunk.size()));
+        }
+        if (std::find(bounds.begin(), bounds.end(), 0) != bounds.end()) {
+            allocated.resize(chunks.size());
+            return;
+        }
+        std::size_t total = 0;
+        for (std::size_t bound : bounds) {
+            total += bound;
+        }
+        // Zero-initialization faults the buffer in
+        buffer.resize(total);
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            outputs[i] = std::span(buffer).subspan(offset, bounds[i]);
+            offset += bounds[i];
+        }
+    }
+
+    std::span<const std::uint8_t> chunk(std::size_t i) const {
+        if (!allocated.empty()) {
+            return allocated[i].data;
+        }
+        return outputs[i].first(sizes[i]);
+    }
+};
+
+// Compress all chunks, spreading contiguous ranges of chunks over the pool
+// with one compressor clone per worker. Returns the wall-clock time.
+Milliseconds compressAll(
+    ThreadPool* pool,
+    const std::vector<std::unique_ptr<Compressor>>& clones,
+    const std::vector<std::vector<float>>& chunks,
+    CompressedChunks& compressed
+)
+{
+    const std::size_t numTasks = std::min(clones.size(), chunks.size());
+    auto work = [&](std::size_t task) {
+        const std::size_t first = task * chunks.size() / numTasks;
+        const std::size_t count = (task + 1) * chunks.size() / numTasks - first;
+        if (!compressed.allocated.empty()) {
+            for (std::size_t i = first; i < first + count; ++i) {
+                compressed.allocated[i] = clones[task]->compress(chunks[i]);
+            }
+            return;
+        }
+        clones[task]->compressChunksInto(
+            std::span(chunks).subspan(first, count),
+            std::span(compressed.outputs).subspan(first, count),
+            std::span(compressed.sizes).subspan(first, count));
+    };
+
+    return timedTasks(pool, numTasks, work);
+}
+
+// Decompress all chunks the same way as compressAll, each into its slice of
+// output, which is allocated and faulted in by the caller.
+Milliseconds decompressAll(
+    ThreadPool* pool,
+    const std::vector<std::unique_ptr<Compressor>>& clones,
+    const std::vector<std::vector<float>>& chunks,
+    const CompressedChunks& compressed,
+    std::vector<float>& output
+)
+{
+    std::vector<std::size_t> offsets(chunks.size() + 1, 0);
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        offsets[i + 1] = offsets[i] + chunks[i].size();
+    }
+    const std::size_t numTasks = std::min(clones.size(), chunks.size());
+    auto work = [&](std::size_t task) {
+        for (std::size_t i = task * chunks.size() / numTasks; i < (task + 1) * chunks.size() / numTasks; ++i) {
+            clones[task]->decompressInto(
+                compressed.chunk(i), std::span(output).subspan(offsets[i], chunks[i].size()));
+        }
+    };
+
+    return timedTasks(pool, numTasks, work);
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+// Time one case: a warm-up run, then args.repeats measured runs.
+CaseResult runCase(
+    const Case& c,
+    const MicrobenchArgs& args,
+    const Compressor& prototype,
+    const std::vector<std::vector<float>>& chunks,
+    ThreadPool* pool
+)
+{
+    std::vector<std::unique_ptr<Compressor>> clones;
+    for (std::size_t t = 0; t < c.threads; ++t) {
+        clones.push_back(prototype.clone());
+    }
+
+    // Outputs are allocated once, before any timed run
+    const double megabytes = c.sizeBytes / (1024.0 * 1024.0);
+    CompressedChunks compressed(prototype, chunks);
+    std::vector<float> decompressed(c.sizeBytes / sizeof(float));
+    std::vector<double> compressionMbps;
+    std::vector<double> decompressionMbps;
+    for (int run = -1; run < args.repeats; ++run) {
+        const Milliseconds compressTime = compressAll(pool, clones, chunks, compressed);
+        const Milliseconds decompressTime = decompressAll(pool, clones, chunks, compressed, decompressed);
+        if (run >= 0) {
+            compressionMbps.push_back(megabytes / (compressTime.count() / 1000.0));
+            decompressionMbps.push_back(megabytes / (decompressTime.count() / 1000.0));
+        }
+    }
+
+    std::size_t compressedBytes = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        compressedBytes += compressed.chunk(i).size();
+    }
+    return {
+        .compressionRatio = static_cast<double>(c.sizeBytes) / compressedBytes,
+        .compressionBestMbps = *std::max_element(compressionMbps.begin(), compressionMbps.end()),
+        .compressionMedianMbps = median(compressionMbps),
+        .decompressionBestMbps = *std::max_element(decompressionMbps.begin(), decompressionMbps.end()),
+        .decompressionMedianMbps = median(decompressionMbps)
+    };
+}
+
+nlohmann::json makeSystemJSON() {
+    const SystemInfo info = collectSystemInfo();
+    return {
+        {"kernel", info.kernel},
+        {"cpu_model", info.cpuModel},
+        {"cpu_governor", info.governor},
+        {"cpu_freq_mhz", info.cpuFrequencyMHz},
+        {"smt", info.smt},
+        {"affinity", formatCpuList(info.affinity)}
+    };
+}
+
+// Compare against the baseline by best-of-repeats throughput, which is less
+// sensitive to interference than the median. Returns the number of regressions.
+int compareWithBaseline(const std::vector<nlohmann::json>& results, const MicrobenchArgs& args) {
+    std::ifstream in(args.baselineFile);
+    if (!in) {
+        throw std::runtime_error("Failed to open baseline: " + args.baselineFile);
+    }
+    std::map<std::string, nlohmann::json> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            nlohmann::json entry = nlohmann::json::parse(line);
+            const std::string key = entry["case"]["key"];
+            baseline[key] = std::move(entry);
+        }
+    }
+
+    std::cout << std::format("\nComparison with {} (regression threshold {:.0f}%):\n",
+                             args.baselineFile, 100.0 * args.threshold);
+    int regressions = 0;
+    for (const auto& result : results) {
+        const std::string key = result["case"]["key"];
+        const auto it = baseline.find(key);
+        if (it == baseline.end()) {
+            std::cout << std::format("  {:<40} not in baseline\n", key);
+            continue;
+        }
+
+        std::string verdict = "ok";
+        std::string changes;
+        for (const char* metric : {"compression_throughput_mbps", "decompression_throughput_mbps"}) {
+            const double now = result["results"][metric]["best"];
+            const double before = it->second["results"][metric]["best"];
+            const double change = now / before - 1.0;
+            changes += std::format("  {} {:+.1f}%", metric, 100.0 * change);
+            if (change < -args.threshold) {
+                verdict = "REGRESSION";
+            }
+        }
+        const double ratioNow = result["results"]["compression_ratio"];
+        const double ratioBefore = it->second["results"]["compression_ratio"];
+        changes += std::format("  ratio {:+.2f}%", 100.0 * (ratioNow / ratioBefore - 1.0));
+
+        std::cout << std::format("  {:<40} {:<10}{}\n", key, verdict, changes);
+        regressions += verdict != "ok";
+    }
+    return regressions;
+}
+
+} // namespace
+
+static int run(int argc, char* argv[]) {
+    MicrobenchArgs args = parseArgs(argc, argv);
+    if (!args.pinCpus.empty()) {
+        pinCurrentThread({args.pinCpus.front()});
+    }
+
+    // Workers take the pinned CPUs after the main thread's, wrapping around
+    ThreadPool pool(args.threads, [&args](std::size_t index) {
+        if (!args.pinCpus.empty()) {
+            pinCurrentThread({args.pinCpus[(index + 1) % args.pinCpus.size()]});
+        }
+    });
+    const nlohmann::json system = makeSystemJSON();
+
+    std::ofstream out(args.resultsFile);
+    if (!out) {
+        throw std::runtime_error("Failed to open results file: " + args.resultsFile);
+    }
+
+    std::vector<nlohmann::json> results;
+    int failures = 0;
+    for (const auto& shape : args.shapes) {
+        for (std::size_t sizeBytes : args.sizes) {
+            const std::vector<float> data = makeData(shape, sizeBytes / sizeof(float), args.seed);
+            const std::vector<std::vector<float>> chunks = splitIntoChunks(data, args.chunkSize);
+
+            for (const auto& name : args.compressors) {
+                std::unique_ptr<Compressor> prototype = createCompressor(name);
+                prototype->configure({});
+
+                // Threaded runs need at least two chunks to split
+                std::vector<std::size_t> threadCounts{1};
+                if (args.threads > 1 && chunks.size() > 1) {
+                    threadCounts.push_back(args.threads);
+                }
+
+                for (std::size_t threads : threadCounts) {
+                    const Case c{name, shape, data.size() * sizeof(float), threads};
+                    CaseResult result{};
+                    try {
+                        result = runCase(c, args, *prototype, chunks, threads > 1 ? &pool : nullptr);
+                    } catch (const std::exception& e) {
+                        std::cerr << std::format("{}: failed: {}\n", c.key(), e.what());
+                        ++failures;
+                        continue;
+                    }
+
+                    std::cout << std::format("{:<40} ratio {:8.3f}  compress {:9.1f} MB/s  decompress {:9.1f} MB/s\n",
+                                             c.key(), result.compressionRatio,
+                                             result.compressionBestMbps, result.decompressionBestMbps);
+
+                    nlohmann::json j;
+                    j["system"] = system;
+                    j["case"] = {
+                        {"key", c.key()},
+                        {"compressor", c.compressor},
+                        {"compressor_config", prototype->getConfig()},
+                        {"compressor_version", prototype->version()},
+                        {"shape", c.shape},
+                        {"size_bytes", c.sizeBytes},
+                        {"chunk_size", args.chunkSize},
+                        {"threads", c.threads},
+                        {"repeats", args.repeats},
+                        {"seed", args.seed}
+                    };
+                    j["results"] = {
+                        {"compression_ratio", result.compressionRatio},
+                        {"compression_throughput_mbps", {
+                            {"best", result.compressionBestMbps},
+                            {"median", result.compressionMedianMbps}
+                        }},
+                        {"decompression_throughput_mbps", {
+                            {"best", result.decompressionBestMbps},
+                            {"median", result.decompressionMedianMbps}
+                        }}
+                    };
+                    out << j.dump() << '\n';
+                    results.push_back(std::move(j));
+                }
+            }
+        }
+    }
+    out.close();
+    std::cout << std::format("Wrote {} results to {}\n", results.size(), args.resultsFile);
+
+    const int regressions = args.baselineFile.empty() ? 0 : compareWithBaseline(results, args);
+    if (regressions > 0) {
+        std::cout << std::format("{} case(s) regressed by more than {:.0f}%.\n", regressions, 100.0 * args.threshold);
+    }
+    return (failures > 0 || regressions > 0) ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Report bad arguments and unwritable files instead of terminating
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "BufferPool.hpp"
+#include "platform.hpp"
+
+namespace {
+
+constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Acquisitions by the calling thread, from any pool
+thread_local BufferPoolStats tThreadStats;
+
+std::size_t pageSize() {
+    static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// Map an anonymous read-write region; nullptr on failure.
+std::uint8_t* mapAnonymous(std::size_t size, int extraFlags) {
+    void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+    return address == MAP_FAILED ? nullptr : static_cast<std::uint8_t*>(address);
+}
+
+// Map size bytes starting on a huge page boundary, so that the kernel can back
+// the whole region with transparent huge pages: over-map by one huge page and
+// unmap the unaligned head and tail.
+std::uint8_t* mapHugePageAligned(std::size_t size) {
+    std::uint8_t* region = mapAnonymous(size + kHugePageSize, 0);
+    if (!region) {
+        return nullptr;
+    }
+    const auto address = reinterpret_cast<std::uintptr_t>(region);
+    auto* aligned = reinterpret_cast<std::uint8_t*>((address + kHugePageSize - 1) & ~(kHugePageSize - 1));
+    if (aligned > region) {
+        ::munmap(region, aligned - region);
+    }
+    if (const std::size_t tail = region + size + kHugePageSize - (aligned + size); tail > 0) {
+        ::munmap(aligned + size, tail);
+    }
+    return aligned;
+}
+
+} // namespace
+
+HugePages parseHugePages(const std::string& value) {
+    if (value == "none") {
+        return HugePages::None;
+    }
+    if (value == "thp") {
+        return HugePages::Transparent;
+    }
+    if (value == "explicit") {
+        return HugePages::Explicit;
+    }
+    throw std::invalid_argument("Invalid huge page mode: " + value + ". Must be none, thp or explicit.");
+}
+
+std::string formatHugePages(HugePages hugePages) {
+    switch (hugePages) {
+        case HugePages::Transparent: return "thp";
+        case HugePages::Explicit: return "explicit";
+        default: return "none";
+    }
+}
+
+BufferPoolStats& BufferPoolStats::operator+=(const BufferPoolStats& other) {
+    acquisitions += other.acquisitions;
+    reuses += other.reuses;
+    mappings += other.mappings;
+    mappedBytes += other.mappedBytes;
+    hugePageFallbacks += other.hugePageFallbacks;
+    prefaultFaults += other.prefaultFaults;
+    mapElapsed += other.mapElapsed;
+    return *this;
+}
+
+BufferPoolStats BufferPoolStats::operator-(const BufferPoolStats& other) const {
+    return {
+        .acquisitions = acquisitions - other.acquisitions,
+        .reuses = reuses - other.reuses,
+        .mappings = mappings - other.mappings,
+        .mappedBytes = mappedBytes - other.mappedBytes,
+        .hugePageFallbacks = hugePageFallbacks - other.hugePageFallbacks,
+        .prefaultFaults = prefaultFaults - other.prefaultFaults,
+        .mapElapsed = mapElapsed - other.mapElapsed
+    };
+}
+
+PooledBuffer::PooledBuffer(BufferPool* pool, std::uint8_t* data, std::size_t size, std::size_t capacity)
+    : _pool(pool), _data(data), _size(size), _capacity(capacity)
+{
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+    : _pool(other._pool), _data(other._data), _size(other._size), _capacity(other._capacity)
+{
+    other._pool = nullptr;
+    other._data = nullptr;
+    other._size = 0;
+    other._capacity = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        _pool = other._pool;
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._pool = nullptr;
+        other._data = nullptr;
+        other._size = 0;
+        other._capacity = 0;
+    }
+    return *this;
+}
+
+PooledBuffer::~PooledBuffer() {
+    release();
+}
+
+void PooledBuffer::release() {
+    if (_pool && _data) {
+        _pool->release(_data, _capacity);
+    }
+    _pool = nullptr;
+    _data = nullptr;
+}
+
+BufferPool::BufferPool(HugePages hugePages) : _hugePages(hugePages) {
+}
+
+BufferPool::~BufferPool() {
+    // Borrowed buffers must not outlive the pool; unmap everything
+    for (const auto& [data, capacity] : _mapped) {
+        ::munmap(data, capacity);
+    }
+}
+
+BufferPool& BufferPool::global() {
+    static BufferPool pool;
+    return pool;
+}
+
+PooledBuffer BufferPool::acquire(std::size_t size) {
+    const std::size_t capacity = std::bit_ceil(std::max(size, pageSize()));
+
+    std::unique_lock lock(_mutex);
+    BufferPoolStats acquired{.acquisitions = 1};
+    std::uint8_t* data = nullptr;
+    if (auto it = _free.find(capacity); it != _free.end() && !it->second.empty()) {
+        data = it->second.back();
+        it->second.pop_back();
+        acquired.reuses = 1;
+    } else {
+        // Map outside the lock; other threads may reuse buffers meanwhile
+        lock.unlock();
+        data = map(capacity, acquired);
+        lock.lock();
+        _mapped[data] = capacity;
+    }
+    _stats += acquired;
+    tThreadStats += acquired;
+    return PooledBuffer(this, data, size, capacity);
+}
+
+std::uint8_t* BufferPool::map(std::size_t capacity, BufferPoolStats& stats) {
+    const HugePages hugePages = this->hugePages();
+    const auto start = std::chrono::steady_clock::now();
+    const PageFaults faultsBefore = currentThreadPageFaults();
+
+    // Huge pages only pay off for buffers of at least one huge page
+    std::uint8_t* data = nullptr;
+    if (capacity >= kHugePageSize && hugePages == HugePages::Explicit) {
+        data = mapAnonymous(capacity, MAP_HUGETLB);
+        stats.hugePageFallbacks = data ? 0 : 1;
+    } else if (capacity >= kHugePageSize && hugePages == HugePages::Transparent) {
+        data = mapHugePageAligned(capacity);
+        if (data) {
+            // Advisory; ignored if THP is disabled
+            ::madvise(data, capacity, MADV_HUGEPAGE);
+        }
+    }
+    if (!data) {
+        data = mapAnonymous(capacity, 0);
+    }
+    if (!data) {
+        throw std::bad_alloc();
+    }
+
+    // Prefault with a write to every page
+    for (std::size_t offset = 0; offset < capacity; offset += pageSize()) {
+        static_cast<volatile std::uint8_t*>(data)[offset] = 0;
+    }
+
+    stats.mappings = 1;
+    stats.mappedBytes = capacity;
+    stats.prefaultFaults = currentThreadPageFaults().minor - faultsBefore.minor;
+    stats.mapElapsed = std::chrono::steady_clock::now() - start;
+    return data;
+}
+
+void BufferPool::release(std::uint8_t* data, std::size_t capacity) {
+    std::lock_guard lock(_mutex);
+    _free[capacity].push_back(data);
+}
+
+void BufferPool::setHugePages(HugePages hugePages) {
+    trim();
+    std::lock_guard lock(_mutex);
+    _hugePages = hugePages;
+}
+
+HugePages BufferPool::hugePages() const {
+    std::lock_guard lock(_mutex);
+    return _hugePages;
+}
+
+void BufferPool::trim() {
+    std::lock_guard lock(_mutex);
+    for (auto& [capacity, buffers] : _free) {
+        for (std::uint8_t* data : buffers) {
+            ::munmap(data, capacity);
+            _mapped.erase(data);
+        }
+    }
+    _free.clear();
+}
+
+BufferPoolStats BufferPool::stats() const {
+    std::lock_guard lock(_mutex);
+    return _stats;
+}
+
+BufferPoolStats BufferPool::threadStats() {
+    return tThreadStats;
+}
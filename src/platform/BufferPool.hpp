@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+// Page size used for pool buffers.
+//   None:        normal 4 KB pages
+//   Transparent: 2 MB-aligned mappings advised with MADV_HUGEPAGE, so the
+//                kernel backs them with transparent huge pages when it can
+//   Explicit:    MAP_HUGETLB mappings from the reserved huge page pool
+//                (vm.nr_hugepages); falls back to normal pages when it is empty
+enum class HugePages {
+    None,
+    Transparent,
+    Explicit
+};
+
+// Parse "none", "thp" or "explicit"; throws std::invalid_argument otherwise.
+HugePages parseHugePages(const std::string& value);
+
+// The inverse of parseHugePages.
+std::string formatHugePages(HugePages hugePages);
+
+// Counters of a BufferPool, or of the calling thread's use of any pool.
+struct BufferPoolStats {
+    std::size_t acquisitions{0};
+    // Acquisitions served from a buffer released earlier
+    std::size_t reuses{0};
+    // Acquisitions that had to map and prefault a new buffer
+    std::size_t mappings{0};
+    std::size_t mappedBytes{0};
+    // Explicit huge page mappings that fell back to normal pages
+    std::size_t hugePageFallbacks{0};
+    // Page faults taken while prefaulting new buffers
+    long prefaultFaults{0};
+    // Time spent mapping and prefaulting new buffers
+    std::chrono::duration<double, std::milli> mapElapsed{0};
+
+    BufferPoolStats& operator+=(const BufferPoolStats& other);
+    BufferPoolStats operator-(const BufferPoolStats& other) const;
+};
+
+class BufferPool;
+
+// A buffer borrowed from a BufferPool and returned to it on destruction.
+// Its contents are unspecified when acquired.
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    PooledBuffer(PooledBuffer&& other) noexcept;
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+    ~PooledBuffer();
+
+    std::uint8_t* data() const { return _data; }
+    // Bytes requested; the mapping may be larger
+    std::size_t size() const { return _size; }
+    std::span<std::uint8_t> bytes() const { return {_data, _size}; }
+
+private:
+    friend class BufferPool;
+    PooledBuffer(BufferPool* pool, std::uint8_t* data, std::size_t size, std::size_t capacity);
+    void release();
+
+    BufferPool* _pool = nullptr;
+    std::uint8_t* _data = nullptr;
+    std::size_t _size = 0;
+    std::size_t _capacity = 0;
+};
+
+// Thread-safe pool of page-aligned scratch buffers that are reused across
+// chunks, repeats and configurations instead of being allocated, zeroed and
+// faulted in for every call. Buffers are grouped into power-of-two size
+// classes; a new one is mapped with mmap and every page is touched before it
+// is handed out, so the page faults happen once, outside measured code.
+// Released buffers stay mapped until trim() or destruction.
+class BufferPool {
+public:
+    explicit BufferPool(HugePages hugePages = HugePages::None);
+    ~BufferPool();
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // The process-wide pool used by the compressors and benchmarks.
+    static BufferPool& global();
+
+    // Borrow a buffer of at least size bytes.
+    // Throws std::bad_alloc if no memory can be mapped.
+    PooledBuffer acquire(std::size_t size);
+
+    // Change the page size of buffers mapped from now on; buffers already in
+    // the pool are unmapped.
+    void setHugePages(HugePages hugePages);
+    HugePages hugePages() const;
+
+    // Unmap all buffers not currently borrowed.
+    void trim();
+
+    // Counters since the pool was created.
+    BufferPoolStats stats() const;
+
+    // Counters of the calling thread's acquisitions from any pool since the
+    // thread started; take differences to attribute them to a region of code.
+    static BufferPoolStats threadStats();
+
+private:
+    friend class PooledBuffer;
+    void release(std::uint8_t* data, std::size_t capacity);
+    std::uint8_t* map(std::size_t capacity, BufferPoolStats& stats);
+
+    mutable std::mutex _mutex;
+    HugePages _hugePages;
+    // Free buffers by capacity
+    std::map<std::size_t, std::vector<std::uint8_t*>> _free;
+    // Capacity of every mapped buffer by address, borrowed or free
+    std::map<std::uint8_t*, std::size_t> _mapped;
+    BufferPoolStats _stats;
+};
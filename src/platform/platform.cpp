@@ -0,0 +1,186 @@
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include "platform.hpp"
+
+namespace {
+
+// From <linux/mempolicy.h>; not every libc exposes it
+constexpr int kMpolBind = 2;
+
+// First line of a sysfs/procfs file, or "" if it cannot be read.
+std::string readFirstLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+std::string cpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        // "model name" on x86; "Model" or "CPU part" on some ARM kernels
+        for (const char* key : {"model name", "Model", "CPU part"}) {
+            if (line.rfind(key, 0) == 0) {
+                const auto colon = line.find(':');
+                if (colon != std::string::npos) {
+                    return line.substr(line.find_first_not_of(' ', colon + 1));
+                }
+            }
+        }
+    }
+    return "";
+}
+
+// CPUs in the affinity mask of thread tid (0 for the calling thread)
+std::vector<int> threadAffinity(pid_t tid) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<int> cpus;
+    if (::sched_getaffinity(tid, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+} // namespace
+
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        try {
+            const auto dash = item.find('-');
+            if (dash == std::string::npos) {
+                cpus.push_back(std::stoi(item));
+                continue;
+            }
+            const int first = std::stoi(item.substr(0, dash));
+            const int last = std::stoi(item.substr(dash + 1));
+            if (first > last) {
+                throw std::invalid_argument(item);
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Invalid CPU list item '" + item + "' in '" + list + "'");
+        }
+    }
+    if (cpus.empty()) {
+        throw std::invalid_argument("Empty CPU list");
+    }
+    return cpus;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::string list;
+    for (std::size_t i = 0; i < cpus.size(); ) {
+        std::size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        list += list.empty() ? "" : ",";
+        list += (j > i) ? std::format("{}-{}", cpus[i], cpus[j]) : std::to_string(cpus[i]);
+        i = j + 1;
+    }
+    return list;
+}
+
+void pinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            throw std::runtime_error(std::format("CPU {} is out of range.", cpu));
+        }
+        CPU_SET(cpu, &set);
+    }
+    if (::sched_setaffinity(0, sizeof(set), &set) != 0) {
+        throw std::runtime_error(std::format(
+            "Failed to pin thread to CPUs {}: {}", formatCpuList(cpus), std::strerror(errno)));
+    }
+}
+
+std::vector<int> currentThreadAffinity() {
+    return threadAffinity(0);
+}
+
+std::vector<int> processAffinity() {
+    return threadAffinity(::getpid());
+}
+
+void bindMemoryToNumaNode(int node) {
+    constexpr int kBitsPerWord = 8 * sizeof(unsigned long);
+    if (node < 0 || node >= 16 * kBitsPerWord) {
+        throw std::runtime_error(std::format("NUMA node {} is out of range.", node));
+    }
+    std::vector<unsigned long> mask(node / kBitsPerWord + 1, 0);
+    mask[node / kBitsPerWord] |= 1ul << (node % kBitsPerWord);
+
+    const unsigned long maxNode = mask.size() * kBitsPerWord;
+    if (::syscall(SYS_set_mempolicy, kMpolBind, mask.data(), maxNode + 1) != 0) {
+        throw std::runtime_error(std::format(
+            "Failed to bind memory to NUMA node {}: {}", node, std::strerror(errno)));
+    }
+}
+
+PageFaults currentThreadPageFaults() {
+    rusage usage{};
+    if (::getrusage(RUSAGE_THREAD, &usage) != 0) {
+        return {};
+    }
+    return {
+        .minor = usage.ru_minflt,
+        .major = usage.ru_majflt
+    };
+}
+
+SystemInfo collectSystemInfo() {
+    SystemInfo info;
+    info.cpuModel = cpuModel();
+
+    utsname uts{};
+    if (::uname(&uts) == 0) {
+        info.kernel = std::format("{} {} {}", uts.sysname, uts.release, uts.version);
+    }
+
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        info.cpu = static_cast<int>(cpu);
+        info.numaNode = static_cast<int>(node);
+    }
+
+    if (info.cpu >= 0) {
+        const std::string cpufreq = std::format("/sys/devices/system/cpu/cpu{}/cpufreq/", info.cpu);
+        info.governor = readFirstLine(cpufreq + "scaling_governor");
+        const std::string curFreq = readFirstLine(cpufreq + "scaling_cur_freq");
+        const std::string maxFreq = readFirstLine(cpufreq + "cpuinfo_max_freq");
+        // cpufreq reports kHz
+        info.cpuFrequencyMHz = curFreq.empty() ? 0.0 : std::stod(curFreq) / 1000.0;
+        info.cpuMaxFrequencyMHz = maxFreq.empty() ? 0.0 : std::stod(maxFreq) / 1000.0;
+    }
+
+    info.smt = readFirstLine("/sys/devices/system/cpu/smt/control");
+    info.affinity = currentThreadAffinity();
+    return info;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Parse a CPU list such as "0-3,8,10-11"; throws std::invalid_argument on error.
+std::vector<int> parseCpuList(const std::string& list);
+
+// Format CPUs as a compact list, the inverse of parseCpuList.
+std::string formatCpuList(const std::vector<int>& cpus);
+
+// Restrict the calling thread to the given CPUs with sched_setaffinity.
+// Threads created afterwards inherit the affinity.
+// Throws std::runtime_error on failure.
+void pinCurrentThread(const std::vector<int>& cpus);
+
+// CPUs the calling thread may run on.
+std::vector<int> currentThreadAffinity();
+
+// CPUs the main thread may run on (the affinity of the process ID). Threads
+// pinned to a single CPU use it to let the threads they start spread out again.
+std::vector<int> processAffinity();
+
+// Allocate all future memory of the calling thread (and threads it creates)
+// on one NUMA node, with set_mempolicy(MPOL_BIND). Pages are placed when they
+// are first touched, so call this before reading data.
+// Throws std::runtime_error on failure.
+void bindMemoryToNumaNode(int node);
+
+// Page faults taken by the calling thread since it started, from
+// getrusage(RUSAGE_THREAD). Minor faults map a page already in memory (e.g.
+// the first touch of freshly allocated memory); major faults read from disk.
+struct PageFaults {
+    long minor{0};
+    long major{0};
+};
+
+PageFaults currentThreadPageFaults();
+
+// Description of the machine a result was measured on.
+struct SystemInfo {
+    std::string cpuModel;
+    std::string kernel;
+    // CPU and NUMA node the calling thread is running on
+    int cpu{-1};
+    int numaNode{-1};
+    // cpufreq state of that CPU; empty/zero if cpufreq is unavailable
+    std::string governor;
+    double cpuFrequencyMHz{0.0};
+    double cpuMaxFrequencyMHz{0.0};
+    // Simultaneous multithreading: "on", "off", "notsupported", ... or empty
+    std::string smt;
+    std::vector<int> affinity;
+};
+
+// Collect SystemInfo for the calling thread from /proc, /sys and uname.
+// Missing files leave the corresponding fields empty.
+SystemInfo collectSystemInfo();
@@ -1,21 +1,49 @@
+#include <Compression.h>
 #include <TBranch.h>
 #include <TFile.h>
+#include <TMemFile.h>
+#include <TROOT.h>
 #include <TTree.h>
 #include <TTreeReader.h>
 #include <TTreeReaderValue.h>
 
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <format>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "root-utils.hpp"
+
+void enableRootThreadSafety() {
+    ROOT::EnableThreadSafety();
+}
+
 std::vector<float> readVectorFloatBranchData(
     const std::string& filepath,
     const std::string& treename,
     const std::string& branchname
 )
+{
+    std::vector<std::uint32_t> entrySizes;
+    return readVectorFloatBranchData(filepath, treename, branchname, entrySizes);
+}
+
+std::vector<float> readVectorFloatBranchData(
+    const std::string& filepath,
+    const std::string& treename,
+    const std::string& branchname,
+    std::vector<std::uint32_t>& entrySizes
+)
 {
     // Open file
     auto file = std::unique_ptr<TFile>(TFile::Open(filepath.c_str(), "READ"));
@@ -46,12 +74,15 @@ std::vector<float> readVectorFloatBranchData(
     }
 
     std::vector<float> values;
+    entrySizes.clear();
+    entrySizes.reserve(tree->GetEntries());
 
     // Loop over all entries in the tree
     // Load branch data into flattened vector
     while (reader.Next()) {
         const auto& entryValues = *branch;
         values.insert(values.end(), entryValues.begin(), entryValues.end());
+        entrySizes.push_back(static_cast<std::uint32_t>(entryValues.size()));
     }
 
     return values;
@@ -135,4 +166,224 @@ void insertVectorFloatBranch(
     // Ensure the tree entry count stays aligned and write the updated tree back.
     tree->SetEntries(nEntries);
     tree->Write("", TObject::kOverwrite);
-}
\ No newline at end of file
+}
+
+int parseRootCompressionSettings(const std::string& spec) {
+    using Algorithm = ROOT::RCompressionSetting::EAlgorithm;
+    static const std::map<std::string, Algorithm::EValues> algorithms = {
+        {"zlib", Algorithm::kZLIB},
+        {"lzma", Algorithm::kLZMA},
+        {"lz4", Algorithm::kLZ4},
+        {"zstd", Algorithm::kZSTD},
+    };
+
+    const auto colon = spec.find(':');
+    const auto algorithm = algorithms.find(spec.substr(0, colon));
+    const std::string level = colon == std::string::npos ? "" : spec.substr(colon + 1);
+    if (algorithm == algorithms.end() || level.size() != 1 || level[0] < '0' || level[0] > '9') {
+        throw std::invalid_argument(std::format(
+            "Invalid ROOT compression '{}'. Must be <zlib|lzma|lz4|zstd>:<level 0-9>.", spec));
+    }
+    return ROOT::CompressionSettings(algorithm->second, level[0] - '0');
+}
+
+RootBasketResult measureRootBasketCompression(
+    const std::vector<float>& values,
+    const std::vector<std::uint32_t>& entrySizes,
+    const std::string& branchname,
+    int compressionSettings,
+    int basketSize
+)
+{
+    RootBasketResult result{.numEntries = entrySizes.size()};
+    const std::string filename = std::format("lossbench-baseline-{}.root", branchname);
+    std::vector<char> fileBytes;
+
+    // Write
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        TMemFile file(filename.c_str(), "RECREATE", "", compressionSettings);
+        TTree tree("baseline", "baseline");
+        tree.SetAutoFlush(0);
+
+        std::vector<float> buffer;
+        auto* branch = tree.Branch(branchname.c_str(), &buffer, basketSize);
+        if (!branch) {
+            throw std::runtime_error(std::format(
+                "Failed to create branch '{}' in the baseline file.", branchname));
+        }
+
+        std::size_t offset = 0;
+        for (std::uint32_t size : entrySizes) {
+            buffer.assign(values.begin() + offset, values.begin() + offset + size);
+            offset += size;
+            tree.Fill();
+        }
+        file.Write();
+        result.writeElapsed = std::chrono::high_resolution_clock::now() - start;
+
+        result.numBaskets = static_cast<std::size_t>(branch->GetWriteBasket());
+        result.totBytes = static_cast<std::size_t>(branch->GetTotBytes("*"));
+        result.zipBytes = static_cast<std::size_t>(branch->GetZipBytes("*"));
+        result.fileBytes = static_cast<std::size_t>(file.GetEND());
+
+        fileBytes.resize(result.fileBytes);
+        file.CopyTo(fileBytes.data(), static_cast<Long64_t>(fileBytes.size()));
+    }
+
+    // Read back from the file's bytes, so nothing is served from the writer's baskets
+    std::vector<float> readValues;
+    readValues.reserve(values.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        TMemFile file(filename.c_str(), fileBytes.data(), static_cast<Long64_t>(fileBytes.size()), "READ");
+        auto* tree = file.Get<TTree>("baseline");
+        if (!tree) {
+            throw std::runtime_error("Failed to read back the baseline tree.");
+        }
+        TTreeReader reader(tree);
+        TTreeReaderValue<std::vector<float>> branch(reader, branchname.c_str());
+        while (reader.Next()) {
+            const auto& entryValues = *branch;
+            readValues.insert(readValues.end(), entryValues.begin(), entryValues.end());
+        }
+    }
+    result.readElapsed = std::chrono::high_resolution_clock::now() - start;
+
+    // Compare bit patterns: ROOT round-trips NaNs exactly, but they never compare equal
+    if (readValues.size() != values.size() ||
+        std::memcmp(readValues.data(), values.data(), values.size() * sizeof(float)) != 0) {
+        throw std::runtime_error(std::format(
+            "Values of branch '{}' read back from the baseline file differ from those written.", branchname));
+    }
+    return result;
+}
+
+void appendResultsTree(
+    const std::string& filepath,
+    const std::string& treename,
+    const std::vector<ResultsRow>& rows
+)
+{
+    auto file = std::unique_ptr<TFile>(TFile::Open(filepath.c_str(), "UPDATE"));
+    if (!file || file->IsZombie()) {
+        throw std::runtime_error(std::format("Failed to open results file for update: {}", filepath));
+    }
+    file->cd();
+
+    // The file owns the tree
+    auto* tree = file->Get<TTree>(treename.c_str());
+    if (!tree) {
+        tree = new TTree(treename.c_str(), "LossBench results");
+    }
+    const Long64_t existingEntries = tree->GetEntries();
+
+    // Column buffers; std::map nodes keep their addresses while columns are added
+    constexpr double kMissing = std::numeric_limits<double>::quiet_NaN();
+    std::map<std::string, double> numberColumns;
+    std::map<std::string, std::string> stringColumns;
+    std::map<std::string, std::string*> stringAddresses;
+
+    // Existing columns keep their type
+    TObjArray* branches = tree->GetListOfBranches();
+    for (int i = 0; branches && i < branches->GetEntries(); ++i) {
+        auto* branch = static_cast<TBranch*>(branches->At(i));
+        const std::string name = branch->GetName();
+        if (std::string(branch->GetClassName()) == "string") {
+            stringAddresses[name] = &stringColumns[name];
+            tree->SetBranchAddress(name.c_str(), &stringAddresses[name]);
+        } else {
+            numberColumns[name] = kMissing;
+            tree->SetBranchAddress(name.c_str(), &numberColumns[name]);
+        }
+    }
+
+    // New columns, backfilled for the entries already in the tree
+    auto backfill = [&](TBranch* branch, const std::string& name) {
+        if (!branch) {
+            throw std::runtime_error(std::format(
+                "Failed to create branch '{}' on tree '{}'.", name, treename));
+        }
+        for (Long64_t entry = 0; entry < existingEntries; ++entry) {
+            branch->Fill();
+        }
+    };
+    for (const auto& row : rows) {
+        for (const auto& [name, value] : row.numbers) {
+            if (!numberColumns.contains(name) && !stringColumns.contains(name)) {
+                numberColumns[name] = kMissing;
+                backfill(tree->Branch(name.c_str(), &numberColumns[name]), name);
+            }
+        }
+        for (const auto& [name, value] : row.strings) {
+            if (!numberColumns.contains(name) && !stringColumns.contains(name)) {
+                stringColumns[name] = "";
+                backfill(tree->Branch(name.c_str(), &stringColumns[name]), name);
+            }
+        }
+    }
+
+    // Text cannot be stored in an existing numeric column; report each such column once
+    std::set<std::string> mismatchedColumns;
+    for (const auto& row : rows) {
+        for (const auto& [name, value] : row.strings) {
+            if (numberColumns.contains(name) && mismatchedColumns.insert(name).second) {
+                std::cerr << std::format(
+                    "Warning: text value '{}' for numeric column '{}' of {} is stored as NaN.\n",
+                    value, name, filepath);
+            }
+        }
+    }
+
+    for (const auto& row : rows) {
+        for (auto& [name, value] : numberColumns) {
+            value = kMissing;
+        }
+        for (auto& [name, value] : stringColumns) {
+            value.clear();
+        }
+        for (const auto& [name, value] : row.numbers) {
+            if (numberColumns.contains(name)) {
+                numberColumns[name] = value;
+            } else {
+                stringColumns[name] = std::format("{}", value);
+            }
+        }
+        for (const auto& [name, value] : row.strings) {
+            if (stringColumns.contains(name)) {
+                stringColumns[name] = value;
+            }
+        }
+        tree->Fill();
+    }
+
+    tree->Write("", TObject::kOverwrite);
+}
+
+std::vector<std::string> readResultsStringColumn(
+    const std::string& filepath,
+    const std::string& treename,
+    const std::string& column
+)
+{
+    std::vector<std::string> values;
+    if (!std::filesystem::exists(filepath)) {
+        return values;
+    }
+
+    auto file = std::unique_ptr<TFile>(TFile::Open(filepath.c_str(), "READ"));
+    if (!file || file->IsZombie()) {
+        throw std::runtime_error(std::format("Failed to open results file: {}", filepath));
+    }
+    auto* tree = file->Get<TTree>(treename.c_str());
+    if (!tree || !tree->GetBranch(column.c_str())) {
+        return values;
+    }
+
+    TTreeReader reader(tree);
+    TTreeReaderValue<std::string> value(reader, column.c_str());
+    while (reader.Next()) {
+        values.push_back(*value);
+    }
+    return values;
+}
@@ -1,8 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 
+// Make ROOT safe to use from several threads at once (ROOT::EnableThreadSafety).
+// Must be called before any thread other than main touches ROOT.
+void enableRootThreadSafety();
+
 // Read a single std::vector<float> branch from a TTree and return all values
 // flattened into a single vector.
 std::vector<float> readVectorFloatBranchData(
@@ -10,6 +17,14 @@ std::vector<float> readVectorFloatBranchData(
     const std::string& treename,
     const std::string& branchname);
 
+// As above, and also record the number of values in each entry, so the
+// flattened values can be mapped back to entries.
+std::vector<float> readVectorFloatBranchData(
+    const std::string& filepath,
+    const std::string& treename,
+    const std::string& branchname,
+    std::vector<std::uint32_t>& entrySizes);
+
 // Write a std::vector<float> branch to an existing TTree without changing the
 // entry count. Each inner vector corresponds to one entry; the size must match
 // the tree's existing number of entries.
@@ -28,4 +43,60 @@ void createTreeWithVectorFloatBranch(
     const std::string& branchname,
     const std::vector<std::vector<float>>& branchValues);
 
+// ROOT compression settings (algorithm * 100 + level, e.g. 505) from
+// "<algorithm>:<level>", with algorithm zlib, lzma, lz4 or zstd and level 0-9.
+// Throws std::invalid_argument on error.
+int parseRootCompressionSettings(const std::string& spec);
 
+// A vector<float> branch as ROOT stores it, measured in an in-memory file.
+struct RootBasketResult {
+    std::size_t numEntries{0};
+    std::size_t numBaskets{0};
+    // Serialized entries (values plus per-entry vector headers and basket
+    // offsets) before and after basket compression (TBranch::GetTotBytes and
+    // GetZipBytes)
+    std::size_t totBytes{0};
+    std::size_t zipBytes{0};
+    // The whole file, including keys, the tree header and streamer info
+    std::size_t fileBytes{0};
+    // Filling and writing the tree, and reading every entry back
+    std::chrono::duration<double, std::milli> writeElapsed{0};
+    std::chrono::duration<double, std::milli> readElapsed{0};
+};
+
+// Write values, split into entries of entrySizes values, as a vector<float>
+// branch of a tree in a TMemFile with the given compression settings and
+// basket size, then read it back from a copy of the file's bytes. Auto-flush
+// is disabled so that ROOT keeps the given basket size instead of optimizing
+// it. Throws std::runtime_error if the values read back differ.
+RootBasketResult measureRootBasketCompression(
+    const std::vector<float>& values,
+    const std::vector<std::uint32_t>& entrySizes,
+    const std::string& branchname,
+    int compressionSettings,
+    int basketSize);
+
+// One results row, as numeric and string columns.
+struct ResultsRow {
+    std::map<std::string, double> numbers;
+    std::map<std::string, std::string> strings;
+};
+
+// Append rows to a results TTree, creating the file and tree if needed. Each
+// column is a double or std::string branch. Columns new to the tree are
+// backfilled with NaN or "" for existing entries; columns missing from a row
+// are filled the same way. A value whose type does not match its existing
+// column is stored as a string, or as NaN in a numeric column with a warning
+// on stderr.
+// Not safe for concurrent writers; callers must serialize access to the file.
+void appendResultsTree(
+    const std::string& filepath,
+    const std::string& treename,
+    const std::vector<ResultsRow>& rows);
+
+// Read a std::string column of a results TTree. Returns an empty vector if
+// the file, tree or column does not exist.
+std::vector<std::string> readResultsStringColumn(
+    const std::string& filepath,
+    const std::string& treename,
+    const std::string& column);
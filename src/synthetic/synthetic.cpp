@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "platform.hpp"
+#include "synthetic.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Entries per independently seeded block
+constexpr std::uint64_t kBlockEntries = 1 << 16;
+
+const std::vector<std::string> kJetColumns{"jet_pt", "jet_eta", "jet_phi", "jet_m", "jet_nconst"};
+
+// Random streams; each column draws from its own stream so that columns can
+// be generated independently
+enum Stream : std::uint64_t {
+    kMultiplicity = 0,
+    kPt,
+    kEta,
+    kPhi,
+    kMassFraction,
+    kConstituents
+};
+
+std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+std::mt19937_64 blockRng(std::uint64_t seed, std::uint64_t block, Stream stream) {
+    return std::mt19937_64(splitmix64(seed ^ splitmix64(block * 8 + stream)));
+}
+
+float quantize(double value, double quantum, bool enabled) {
+    return static_cast<float>(enabled ? std::round(value / quantum) * quantum : value);
+}
+
+// Run task(block) for every block, handing out blocks dynamically.
+void parallelForBlocks(std::uint64_t numBlocks, std::size_t threads, const std::function<void(std::uint64_t)>& task) {
+    if (threads == 0) {
+        threads = currentThreadAffinity().size();
+    }
+    threads = std::min<std::size_t>(threads, numBlocks);
+
+    std::atomic<std::uint64_t> next{0};
+    parallelForRanges(threads, [&](std::size_t) {
+        for (std::uint64_t block = next++; block < numBlocks; block = next++) {
+            task(block);
+        }
+    });
+}
+
+// pT of every jet in a block, sorted in descending order within each entry.
+std::vector<double> blockPts(const SyntheticSpec& spec, std::uint64_t block, const std::uint32_t* sizes, std::uint64_t numEntries) {
+    std::mt19937_64 rng = blockRng(spec.seed, block, kPt);
+    std::exponential_distribution<double> tail(1.0 / spec.ptSlope);
+
+    std::vector<double> pts;
+    for (std::uint64_t e = 0; e < numEntries; ++e) {
+        const std::size_t first = pts.size();
+        for (std::uint32_t j = 0; j < sizes[e]; ++j) {
+            pts.push_back(spec.ptMin + tail(rng));
+        }
+        std::sort(pts.begin() + first, pts.end(), std::greater<>());
+    }
+    return pts;
+}
+
+// Fill the values of one column for one block.
+void fillBlock(
+    const SyntheticSpec& spec,
+    const std::string& branch,
+    std::uint64_t block,
+    const std::uint32_t* sizes,
+    std::uint64_t numEntries,
+    float* out,
+    std::size_t numValues
+)
+{
+    const bool q = spec.quantize;
+    if (branch == "jet_pt") {
+        const std::vector<double> pts = blockPts(spec, block, sizes, numEntries);
+        for (std::size_t i = 0; i < numValues; ++i) {
+            out[i] = quantize(pts[i], 1.0, q);
+        }
+    } else if (branch == "jet_m") {
+        const std::vector<double> pts = blockPts(spec, block, sizes, numEntries);
+        std::mt19937_64 rng = blockRng(spec.seed, block, kMassFraction);
+        std::uniform_real_distribution<double> fraction(0.05, 0.20);
+        for (std::size_t i = 0; i < numValues; ++i) {
+            out[i] = quantize(pts[i] * fraction(rng), 1.0, q);
+        }
+    } else if (branch == "jet_eta") {
+        std::mt19937_64 rng = blockRng(spec.seed, block, kEta);
+        std::normal_distribution<double> eta(0.0, spec.etaWidth);
+        for (std::size_t i = 0; i < numValues; ++i) {
+            double value = eta(rng);
+            while (std::abs(value) >= spec.etaMax) {
+                value = eta(rng);
+            }
+            out[i] = quantize(value, 1.0 / 4096, q);
+        }
+    } else if (branch == "jet_phi") {
+        std::mt19937_64 rng = blockRng(spec.seed, block, kPhi);
+        std::uniform_real_distribution<double> phi(-std::numbers::pi, std::numbers::pi);
+        for (std::size_t i = 0; i < numValues; ++i) {
+            out[i] = quantize(phi(rng), 1.0 / 4096, q);
+        }
+    } else if (branch == "jet_nconst") {
+        std::mt19937_64 rng = blockRng(spec.seed, block, kConstituents);
+        std::poisson_distribution<int> constituents(15.0);
+        for (std::size_t i = 0; i < numValues; ++i) {
+            out[i] = static_cast<float>(1 + constituents(rng));
+        }
+    }
+}
+
+} // namespace
+
+SyntheticSpec parseSyntheticSpec(const std::string& spec) {
+    SyntheticSpec parsed;
+    const auto colon = spec.find(':');
+    parsed.generator = spec.substr(0, colon);
+    if (parsed.generator != "jets") {
+        throw std::invalid_argument("Unknown synthetic generator '" + parsed.generator + "'. Must be jets.");
+    }
+    if (colon == std::string::npos) {
+        return parsed;
+    }
+
+    const std::string options = spec.substr(colon + 1);
+    std::size_t start = 0;
+    while (start < options.size()) {
+        std::size_t end = options.find(',', start);
+        if (end == std::string::npos) {
+            end = options.size();
+        }
+        const std::string item = options.substr(start, end - start);
+        start = end + 1;
+
+        const auto separator = item.find('=');
+        if (separator == std::string::npos || separator == 0 || separator == item.size() - 1) {
+            throw std::invalid_argument("Synthetic option must be key=value; saw '" + item + "'");
+        }
+        const std::string key = item.substr(0, separator);
+        const std::string value = item.substr(separator + 1);
+
+        // Counts accept scientific notation, e.g. entries=1e8
+        if (key == "entries") {
+            parsed.entries = static_cast<std::uint64_t>(std::stod(value));
+        } else if (key == "seed") {
+            parsed.seed = std::stoull(value);
+        } else if (key == "mult") {
+            parsed.meanMultiplicity = std::stod(value);
+        } else if (key == "ptMin") {
+            parsed.ptMin = std::stod(value);
+        } else if (key == "ptSlope") {
+            parsed.ptSlope = std::stod(value);
+        } else if (key == "etaWidth") {
+            parsed.etaWidth = std::stod(value);
+        } else if (key == "etaMax") {
+            parsed.etaMax = std::stod(value);
+        } else if (key == "quantize") {
+            parsed.quantize = std::stoi(value) != 0;
+        } else if (key == "threads") {
+            parsed.threads = std::stoul(value);
+        } else {
+            throw std::invalid_argument("Unknown synthetic option: " + key);
+        }
+    }
+
+    // Validate
+    if (parsed.entries == 0) {
+        throw std::invalid_argument("Synthetic entries must be positive");
+    }
+    if (parsed.meanMultiplicity <= 0.0 || parsed.ptSlope <= 0.0 ||
+        parsed.etaWidth <= 0.0 || parsed.etaMax <= 0.0) {
+        throw std::invalid_argument("Synthetic mult, ptSlope, etaWidth and etaMax must be positive");
+    }
+    return parsed;
+}
+
+std::vector<std::string> syntheticBranches(const SyntheticSpec&) {
+    return kJetColumns;
+}
+
+std::vector<float> generateSyntheticBranch(
+    const SyntheticSpec& spec,
+    const std::string& branch,
+    std::vector<std::uint32_t>& entrySizes
+)
+{
+    if (std::find(kJetColumns.begin(), kJetColumns.end(), branch) == kJetColumns.end()) {
+        throw std::invalid_argument("Unknown synthetic branch '" + branch + "'");
+    }
+
+    const std::uint64_t numBlocks = (spec.entries + kBlockEntries - 1) / kBlockEntries;
+    auto blockEntries = [&](std::uint64_t block) {
+        return std::min(kBlockEntries, spec.entries - block * kBlockEntries);
+    };
+
+    // Pass 1: multiplicities, shared by all columns
+    entrySizes.resize(spec.entries);
+    std::vector<std::uint64_t> blockOffsets(numBlocks + 1, 0);
+    parallelForBlocks(numBlocks, spec.threads, [&](std::uint64_t block) {
+        std::mt19937_64 rng = blockRng(spec.seed, block, kMultiplicity);
+        std::poisson_distribution<std::uint32_t> multiplicity(spec.meanMultiplicity);
+        std::uint32_t* sizes = entrySizes.data() + block * kBlockEntries;
+        std::uint64_t numValues = 0;
+        for (std::uint64_t e = 0; e < blockEntries(block); ++e) {
+            sizes[e] = multiplicity(rng);
+            numValues += sizes[e];
+        }
+        blockOffsets[block + 1] = numValues;
+    });
+    for (std::uint64_t block = 0; block < numBlocks; ++block) {
+        blockOffsets[block + 1] += blockOffsets[block];
+    }
+
+    // Pass 2: values, each block written to its own slice of the output
+    std::vector<float> values(blockOffsets.back());
+    parallelForBlocks(numBlocks, spec.threads, [&](std::uint64_t block) {
+        fillBlock(spec, branch, block,
+                  entrySizes.data() + block * kBlockEntries, blockEntries(block),
+                  values.data() + blockOffsets[block],
+                  blockOffsets[block + 1] - blockOffsets[block]);
+    });
+    return values;
+}
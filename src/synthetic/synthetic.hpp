@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Parameters of a synthetic dataset, parsed from a spec such as
+// "jets:entries=1e8,seed=42".
+//
+// The "jets" generator produces one jagged vector<float> column per jet
+// property, with a Poisson number of jets per entry, sorted by falling pT:
+//   jet_pt     -- ptMin plus an exponential with mean ptSlope [MeV]
+//   jet_eta    -- Gaussian with width etaWidth, truncated to |eta| < etaMax
+//   jet_phi    -- uniform in [-pi, pi)
+//   jet_m      -- a uniform fraction (5-20%) of the jet's pT [MeV]
+//   jet_nconst -- 1 + Poisson(15) constituents
+// With quantize=1 (default) values are rounded to detector-like precision:
+// pT and mass to 1 MeV, eta and phi to 1/4096.
+struct SyntheticSpec {
+    std::string generator{"jets"};
+    std::uint64_t entries{1000000};
+    std::uint64_t seed{42};
+    double meanMultiplicity{4.0};
+    double ptMin{20000.0};
+    double ptSlope{30000.0};
+    double etaWidth{1.5};
+    double etaMax{4.5};
+    bool quantize{true};
+    // Generator threads; 0 uses every CPU the calling thread may run on
+    std::size_t threads{0};
+};
+
+// Parse "generator[:key=value,...]"; throws std::invalid_argument on error.
+SyntheticSpec parseSyntheticSpec(const std::string& spec);
+
+// Column (branch) names the generator produces.
+std::vector<std::string> syntheticBranches(const SyntheticSpec& spec);
+
+// Generate one column, flattened, and the number of values in each entry.
+// Entries are generated in fixed-size blocks, each seeded from (seed, block),
+// so the output is identical for any number of threads, and all columns of a
+// spec share the same multiplicities.
+std::vector<float> generateSyntheticBranch(
+    const SyntheticSpec& spec,
+    const std::string& branch,
+    std::vector<std::uint32_t>& entrySizes);
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "container.hpp"
+#include "ZlibCompressor.hpp"
+
+
+// Copy the first numBytes of a file, or all of it with one byte replaced.
+static void writeDamagedCopy(
+    const std::string& source,
+    const std::string& target,
+    std::size_t numBytes,
+    std::size_t corruptOffset = std::string::npos)
+{
+    std::ifstream in(source, std::ios::binary);
+    std::vector<char> bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if (corruptOffset < bytes.size()) {
+        bytes[corruptOffset] ^= 0x5a;
+    }
+    bytes.resize(std::min(numBytes, bytes.size()));
+    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Whether opening a container throws std::runtime_error.
+static bool rejects(const std::string& filepath) {
+    try {
+        ContainerReader container(filepath);
+    } catch (const std::runtime_error& e) {
+        std::cout << std::format("Rejected {}: {}\n", filepath, e.what());
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    const std::string containerFile{"test.lbc"};
+    const std::string damagedFile{"test-damaged.lbc"};
+
+    // Compress random floats with zlib in a few chunks
+    std::vector<float> data = std::vector<float>(100000);
+    std::mt19937 rng(42); // Fixed seed for reproducibility
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (auto& val : data) {
+        val = dist(rng);
+    }
+
+    ZlibCompressor compressor;
+    std::vector<CompressedData> compressedChunks;
+    constexpr std::size_t kChunkFloats = 30000;
+    for (std::size_t start = 0; start < data.size(); start += kChunkFloats) {
+        const std::size_t end = std::min(start + kChunkFloats, data.size());
+        compressedChunks.push_back(compressor.compress(std::vector<float>(data.begin() + start, data.begin() + end)));
+    }
+
+    const ContainerInfo info{
+        .compressor = compressor.name(),
+        .compressorConfig = compressor.getConfig(),
+        .inputFile = "random",
+        .tree = "TestTree",
+        .branch = "TestBranch",
+        .chunkSize = kChunkFloats * sizeof(float),
+        .dictionary = {},
+        .mask = {}
+    };
+    writeContainer(containerFile, info, compressedChunks);
+
+    int failures = 0;
+
+    // Round trip from a cold cache: provenance, sizes and values come back unchanged
+    {
+        dropFromPageCache(containerFile);
+        ContainerReader container(containerFile);
+        std::vector<float> decompressedData(container.info().numFloats);
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < container.numChunks(); ++i) {
+            const ContainerChunk chunk = container.chunk(i);
+            compressor.decompressInto(chunk.bytes, std::span(decompressedData).subspan(offset, chunk.numFloats));
+            offset += chunk.numFloats;
+        }
+
+        std::cout << std::format("Read {} chunks of branch '{}' ({} floats, {} bytes)\n",
+                                 container.numChunks(), container.info().branch,
+                                 container.info().numFloats, container.info().compressedSizeBytes);
+        if (container.numChunks() != compressedChunks.size()
+            || container.info().compressor != info.compressor
+            || container.info().compressorConfig != info.compressorConfig
+            || container.info().branch != info.branch
+            || container.info().chunkSize != info.chunkSize
+            || decompressedData != data)
+        {
+            std::cout << "Round trip FAILED\n";
+            ++failures;
+        }
+    }
+
+    // Truncated inside the header, and just past the magic
+    for (std::size_t numBytes : {std::size_t{40}, std::size_t{9}}) {
+        writeDamagedCopy(containerFile, damagedFile, numBytes);
+        if (!rejects(damagedFile)) {
+            std::cout << std::format("Truncation to {} bytes was NOT rejected\n", numBytes);
+            ++failures;
+        }
+    }
+
+    // Truncated inside the chunk data, so the index points past the end
+    writeDamagedCopy(containerFile, damagedFile, 4096 + 16);
+    if (!rejects(damagedFile)) {
+        std::cout << "Truncated chunk data was NOT rejected\n";
+        ++failures;
+    }
+
+    // Corrupt magic, version, and the length of the compressor name
+    for (std::size_t offset : {std::size_t{0}, std::size_t{8}, std::size_t{43}}) {
+        writeDamagedCopy(containerFile, damagedFile, std::string::npos, offset);
+        if (!rejects(damagedFile)) {
+            std::cout << std::format("Corrupt byte {} was NOT rejected\n", offset);
+            ++failures;
+        }
+    }
+
+    std::remove(containerFile.c_str());
+    std::remove(damagedFile.c_str());
+
+    std::cout << (failures == 0 ? "All container tests passed\n" : "Container tests FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
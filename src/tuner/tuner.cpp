@@ -0,0 +1,315 @@
+#include <array>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tuner.hpp"
+
+namespace {
+
+std::vector<std::string> split(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::size_t start = 0;
+    while (start <= str.size()) {
+        const std::size_t pos = str.find(delimiter, start);
+        if (pos == std::string::npos) {
+            tokens.push_back(str.substr(start));
+            break;
+        }
+        tokens.push_back(str.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return tokens;
+}
+
+// Value of the targeted metric in a benchmark result.
+double targetMetric(const BenchmarkResult& metrics, const TuningTarget& target) {
+    switch (target.metric) {
+        case TuningTarget::Metric::MaxAbsError: return metrics.absErrorMax;
+        case TuningTarget::Metric::MaxRelError: return metrics.relErrorMax;
+        case TuningTarget::Metric::MinPSNR:     return metrics.PSNR;
+        case TuningTarget::Metric::MinRatio:    return metrics.compressionRatio;
+    }
+    return 0.0;
+}
+
+bool meetsTarget(const BenchmarkResult& metrics, const TuningTarget& target) {
+    const double value = targetMetric(metrics, target);
+    switch (target.metric) {
+        case TuningTarget::Metric::MaxAbsError:
+        case TuningTarget::Metric::MaxRelError:
+            return value <= target.value;
+        case TuningTarget::Metric::MinPSNR:
+        case TuningTarget::Metric::MinRatio:
+            return value >= target.value;
+    }
+    return false;
+}
+
+// Error measure used as a Pareto objective (smaller is better).
+double errorObjective(const BenchmarkResult& metrics, const TuningTarget& target) {
+    switch (target.metric) {
+        case TuningTarget::Metric::MaxRelError: return metrics.relErrorMax;
+        case TuningTarget::Metric::MinPSNR:     return -metrics.PSNR;
+        default:                                return metrics.absErrorMax;
+    }
+}
+
+// Chunks and flattened values of a dataset the search runs on.
+struct Dataset {
+    std::vector<std::vector<float>> chunks;
+    std::vector<float> values;
+};
+
+struct Evaluation {
+    BenchmarkResult metrics;
+    std::size_t originalSizeBytes;
+    std::size_t compressedSizeBytes;
+    std::size_t numChunks;
+};
+
+Evaluation evaluate(
+    Compressor& compressor,
+    const std::map<std::string, std::string>& options,
+    const Dataset& dataset
+)
+{
+    compressor.configure(options);
+    CompressionResult compResult{timedCompress(compressor, dataset.chunks)};
+    DecompressionResult decompResult{timedDecompress(compressor, compResult.compressedChunks)};
+    return {
+        .metrics = computeBenchmarkMetrics(dataset.values, compResult, decompResult),
+        .originalSizeBytes = compResult.numFloats() * sizeof(float),
+        .compressedSizeBytes = compResult.compressedSizeBytes(),
+        .numChunks = compResult.compressedChunks.size()
+    };
+}
+
+} // namespace
+
+TuningTarget parseTuningTarget(const std::string& spec) {
+    const auto separator = spec.find('=');
+    if (separator == std::string::npos) {
+        throw std::invalid_argument("Tuning target must be metric=value; saw '" + spec + "'");
+    }
+    const std::string metric = spec.substr(0, separator);
+    const double value = std::stod(spec.substr(separator + 1));
+
+    if (metric == "maxAbsError") {
+        return {TuningTarget::Metric::MaxAbsError, value};
+    } else if (metric == "maxRelError") {
+        return {TuningTarget::Metric::MaxRelError, value};
+    } else if (metric == "minPSNR") {
+        return {TuningTarget::Metric::MinPSNR, value};
+    } else if (metric == "minRatio") {
+        return {TuningTarget::Metric::MinRatio, value};
+    }
+    throw std::invalid_argument(
+        "Unknown tuning target '" + metric + "'. Must be maxAbsError, maxRelError, minPSNR or minRatio.");
+}
+
+TuningParameter parseTuningParameter(const std::string& spec) {
+    const auto tokens = split(spec, ':');
+    if (tokens.size() != 3 || tokens[0].empty()) {
+        throw std::invalid_argument("Tuning parameter must be name:lo:hi; saw '" + spec + "'");
+    }
+
+    TuningParameter parameter{tokens[0], std::stod(tokens[1]), std::stod(tokens[2])};
+    if (parameter.lo <= 0.0 || parameter.hi <= parameter.lo) {
+        throw std::invalid_argument("Tuning parameter range must satisfy 0 < lo < hi; saw '" + spec + "'");
+    }
+    return parameter;
+}
+
+std::vector<std::map<std::string, std::string>> expandTuningGrid(const std::string& spec) {
+    std::vector<std::map<std::string, std::string>> grid{{}};
+    if (spec.empty()) {
+        return grid;
+    }
+
+    for (const auto& item : split(spec, ',')) {
+        const auto separator = item.find('=');
+        if (separator == std::string::npos || separator == 0 || separator == item.size() - 1) {
+            throw std::invalid_argument("Tuning grid item must be key=v1|v2|...; saw '" + item + "'");
+        }
+        const std::string key = item.substr(0, separator);
+
+        std::vector<std::map<std::string, std::string>> expanded;
+        for (const auto& value : split(item.substr(separator + 1), '|')) {
+            for (auto point : grid) {
+                point[key] = value;
+                expanded.push_back(std::move(point));
+            }
+        }
+        grid = std::move(expanded);
+    }
+    return grid;
+}
+
+std::string tuningTargetName(const TuningTarget& target) {
+    switch (target.metric) {
+        case TuningTarget::Metric::MaxAbsError: return "max_abs_error";
+        case TuningTarget::Metric::MaxRelError: return "max_rel_error";
+        case TuningTarget::Metric::MinPSNR:     return "min_psnr";
+        case TuningTarget::Metric::MinRatio:    return "min_ratio";
+    }
+    return "";
+}
+
+std::vector<TuningCandidate> tuneCompressor(
+    Compressor& compressor,
+    const std::map<std::string, std::string>& baseOptions,
+    const std::vector<float>& data,
+    std::size_t chunkSize,
+    const TuningOptions& options
+)
+{
+    // Full branch and its stratified subsample
+    Dataset full{.chunks = splitIntoChunks(data, chunkSize), .values = data};
+    Dataset sample;
+    for (std::size_t i : sampleChunkIndices(full.chunks.size(), options.sampleFraction, options.seed)) {
+        sample.values.insert(sample.values.end(), full.chunks[i].begin(), full.chunks[i].end());
+        sample.chunks.push_back(full.chunks[i]);
+    }
+    std::cout << std::format("Tuning on {} of {} chunks, confirming on the full branch.\n",
+                             sample.chunks.size(), full.chunks.size());
+
+    // Error targets are met by small parameter values, ratio targets by large ones
+    const bool smallIsSafe = options.target.metric != TuningTarget::Metric::MinRatio;
+
+    std::vector<TuningCandidate> candidates;
+    for (const auto& gridPoint : options.grid) {
+        TuningCandidate candidate;
+        candidate.options = baseOptions;
+        for (const auto& [key, value] : gridPoint) {
+            candidate.options[key] = value;
+        }
+
+        auto withParameter = [&](double value) {
+            auto withValue = candidate.options;
+            withValue[options.parameter->name] = std::format("{}", value);
+            return withValue;
+        };
+
+        Evaluation sampleEval{};
+        double value = 0.0;
+        if (options.parameter) {
+            // Bisect on a log scale between a value that meets the target and one that does not
+            double safe = smallIsSafe ? options.parameter->lo : options.parameter->hi;
+            double unsafe = smallIsSafe ? options.parameter->hi : options.parameter->lo;
+
+            sampleEval = evaluate(compressor, withParameter(safe), sample);
+            ++candidate.sampleEvaluations;
+            if (meetsTarget(sampleEval.metrics, options.target)) {
+                Evaluation unsafeEval = evaluate(compressor, withParameter(unsafe), sample);
+                ++candidate.sampleEvaluations;
+                if (meetsTarget(unsafeEval.metrics, options.target)) {
+                    safe = unsafe;
+                    sampleEval = unsafeEval;
+                } else {
+                    for (int step = 0; step < options.steps; ++step) {
+                        const double mid = std::sqrt(safe * unsafe);
+                        Evaluation midEval = evaluate(compressor, withParameter(mid), sample);
+                        ++candidate.sampleEvaluations;
+                        if (meetsTarget(midEval.metrics, options.target)) {
+                            safe = mid;
+                            sampleEval = midEval;
+                        } else {
+                            unsafe = mid;
+                        }
+                    }
+                }
+            }
+            value = safe;
+            candidate.options = withParameter(value);
+        } else {
+            sampleEval = evaluate(compressor, candidate.options, sample);
+            ++candidate.sampleEvaluations;
+        }
+        candidate.sampleMetrics = sampleEval.metrics;
+
+        // Confirm on the full branch, backing off toward the safe end of the range
+        // when the subsample was not representative
+        const double safeEnd = options.parameter
+            ? (smallIsSafe ? options.parameter->lo : options.parameter->hi)
+            : 0.0;
+        constexpr int kMaxBackoffs = 4;
+        Evaluation fullEval{};
+        for (int attempt = 0; ; ++attempt) {
+            fullEval = evaluate(compressor, candidate.options, full);
+            ++candidate.fullEvaluations;
+            candidate.meetsTarget = meetsTarget(fullEval.metrics, options.target);
+            if (candidate.meetsTarget || !options.parameter || attempt == kMaxBackoffs || value == safeEnd) {
+                break;
+            }
+            value = std::sqrt(value * safeEnd);
+            candidate.options = withParameter(value);
+        }
+
+        candidate.compressorConfig = compressor.getConfig();
+        candidate.metrics = fullEval.metrics;
+        candidate.originalSizeBytes = fullEval.originalSizeBytes;
+        candidate.compressedSizeBytes = fullEval.compressedSizeBytes;
+        candidate.numChunks = fullEval.numChunks;
+
+        std::cout << std::format("  grid point {}/{}: {} = {}, ratio {:.3f} ({} sample + {} full runs){}\n",
+                                 candidates.size() + 1, options.grid.size(),
+                                 tuningTargetName(options.target), targetMetric(candidate.metrics, options.target),
+                                 candidate.metrics.compressionRatio,
+                                 candidate.sampleEvaluations, candidate.fullEvaluations,
+                                 candidate.meetsTarget ? "" : ", target not met");
+        candidates.push_back(std::move(candidate));
+    }
+
+    return candidates;
+}
+
+std::vector<TuningCandidate> paretoFront(
+    const std::vector<TuningCandidate>& candidates,
+    const TuningTarget& target
+)
+{
+    // Objectives, all oriented so that larger is better
+    auto objectives = [&](const TuningCandidate& c) {
+        return std::array<double, 4>{
+            c.metrics.compressionRatio,
+            -errorObjective(c.metrics, target),
+            c.metrics.compressionThroughputMbps,
+            c.metrics.decompressionThroughputMbps
+        };
+    };
+    auto dominates = [&](const TuningCandidate& a, const TuningCandidate& b) {
+        const auto oa = objectives(a);
+        const auto ob = objectives(b);
+        bool strictlyBetter = false;
+        for (std::size_t i = 0; i < oa.size(); ++i) {
+            if (oa[i] < ob[i]) {
+                return false;
+            }
+            strictlyBetter = strictlyBetter || oa[i] > ob[i];
+        }
+        return strictlyBetter;
+    };
+
+    std::vector<TuningCandidate> front;
+    for (const auto& candidate : candidates) {
+        if (!candidate.meetsTarget) {
+            continue;
+        }
+        bool dominated = false;
+        for (const auto& other : candidates) {
+            if (other.meetsTarget && dominates(other, candidate)) {
+                dominated = true;
+                break;
+            }
+        }
+        if (!dominated) {
+            front.push_back(candidate);
+        }
+    }
+    return front;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "Compressor.hpp"
+
+// What a tuned configuration must achieve on the full branch.
+struct TuningTarget {
+    enum class Metric { MaxAbsError, MaxRelError, MinPSNR, MinRatio };
+
+    Metric metric;
+    double value;
+};
+
+// A numeric compressor option searched by bisection on a log scale.
+// The option is assumed to be monotone: larger values give a higher
+// compression ratio and a larger error (true for SZ3's error bounds).
+struct TuningParameter {
+    std::string name;
+    double lo;
+    double hi;
+};
+
+struct TuningOptions {
+    TuningTarget target;
+    std::optional<TuningParameter> parameter;
+    // Option overrides to try; each grid point is tuned independently
+    std::vector<std::map<std::string, std::string>> grid;
+    // Fraction of chunks in the subsample used for the search
+    double sampleFraction{0.05};
+    // Number of bisection steps per grid point
+    int steps{10};
+    std::uint64_t seed{42};
+};
+
+// One tuned configuration, confirmed on the full branch.
+struct TuningCandidate {
+    std::map<std::string, std::string> options;
+    std::map<std::string, std::string> compressorConfig;
+    BenchmarkResult sampleMetrics;
+    BenchmarkResult metrics;
+    std::size_t originalSizeBytes{0};
+    std::size_t compressedSizeBytes{0};
+    std::size_t numChunks{0};
+    int sampleEvaluations{0};
+    int fullEvaluations{0};
+    bool meetsTarget{false};
+};
+
+// Parse "maxAbsError=<x>", "maxRelError=<x>", "minPSNR=<x>" or "minRatio=<x>".
+// Throws std::invalid_argument on error.
+TuningTarget parseTuningTarget(const std::string& spec);
+
+// Parse "<option>:<lo>:<hi>"; throws std::invalid_argument on error.
+TuningParameter parseTuningParameter(const std::string& spec);
+
+// Expand "opt1=a|b,opt2=c|d" into the cartesian product of its values.
+// An empty spec expands to a single empty override.
+std::vector<std::map<std::string, std::string>> expandTuningGrid(const std::string& spec);
+
+// Name of a target metric as used in results, e.g. "max_abs_error".
+std::string tuningTargetName(const TuningTarget& target);
+
+// Search the compressor's options for every grid point, first on a subsample
+// of chunks and then confirming on the full branch. baseOptions are applied
+// before each grid point's overrides and the searched parameter.
+std::vector<TuningCandidate> tuneCompressor(
+    Compressor& compressor,
+    const std::map<std::string, std::string>& baseOptions,
+    const std::vector<float>& data,
+    std::size_t chunkSize,
+    const TuningOptions& options);
+
+// Keep the candidates that meet the target and are not dominated in
+// compression ratio, error, and compression/decompression throughput.
+std::vector<TuningCandidate> paretoFront(
+    const std::vector<TuningCandidate>& candidates,
+    const TuningTarget& target);